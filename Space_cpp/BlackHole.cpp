@@ -3,6 +3,7 @@
 #include "UI.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "GLState.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
@@ -52,9 +53,18 @@ void updateBlackHoles(std::vector<BlackHole>& blackHoles, double deltaTime) {
 static unsigned int bhQuadVAO = 0;
 static unsigned int bhQuadVBO = 0;
 
+// Per-hole uniform handles, resolved once per program
+static struct {
+    unsigned int program = 0;
+    Uniform<glm::mat4> model;
+    Uniform<glm::vec3> centerPos;
+    Uniform<float> innerRadius;
+    Uniform<float> outerRadius;
+} bhUniforms;
+
 void renderBlackHoles(const std::vector<BlackHole>& blackHoles, const RenderZone& zone, const Camera& camera,
     const glm::mat4& view, const glm::mat4& projection,
-    unsigned int noiseTexture, Shader* bhShader) {
+    unsigned int noiseTexture, Shader* bhShader, float time) {
     if (blackHoles.empty()) return;
 
     if (bhQuadVAO == 0) {
@@ -70,7 +80,7 @@ void renderBlackHoles(const std::vector<BlackHole>& blackHoles, const RenderZone
         };
         glGenVertexArrays(1, &bhQuadVAO);
         glGenBuffers(1, &bhQuadVBO);
-        glBindVertexArray(bhQuadVAO);
+        GLState::BindVertexArray(bhQuadVAO); // Created lazily inside the frame
         glBindBuffer(GL_ARRAY_BUFFER, bhQuadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -80,19 +90,24 @@ void renderBlackHoles(const std::vector<BlackHole>& blackHoles, const RenderZone
     }
 
     // Use Blend for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::Enable(GL_BLEND);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Quads are depth tested and write depth
+    GLState::Enable(GL_DEPTH_TEST);
+    GLState::DepthMask(GL_TRUE);
 
     bhShader->use();
+    if (bhUniforms.program != bhShader->ID) {
+        bhUniforms.program = bhShader->ID;
+        bhUniforms.model = bhShader->GetUniform<glm::mat4>("model");
+        bhUniforms.centerPos = bhShader->GetUniform<glm::vec3>("centerPos");
+        bhUniforms.innerRadius = bhShader->GetUniform<float>("innerRadius");
+        bhUniforms.outerRadius = bhShader->GetUniform<float>("outerRadius");
+    }
 
-    bhShader->setMat4("view", glm::value_ptr(view));
-    bhShader->setMat4("projection", glm::value_ptr(projection));
-    bhShader->setFloat("time", (float)glfwGetTime());
-    bhShader->setVec3("viewPos", (float)camera.posX, (float)camera.posY, (float)camera.posZ);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, noiseTexture);
-    bhShader->setInt("noiseTexture", 0);
+    // View, projection and time come from GlobalUniforms; the noiseTexture sampler is set at init
+    GLState::BindTexture(0, noiseTexture);
+    GLState::BindVertexArray(bhQuadVAO);
 
 	for (const auto& bh : blackHoles) {
 		float visualScale = 1.5f;
@@ -106,18 +121,16 @@ void renderBlackHoles(const std::vector<BlackHole>& blackHoles, const RenderZone
         model = glm::translate(model, glm::vec3(bh.x, bh.y, bh.z));
         model = glm::scale(model, glm::vec3(size));
 
-        bhShader->setMat4("model", glm::value_ptr(model));
-        bhShader->setVec3("centerPos", bh.x, bh.y, bh.z);
+        bhUniforms.model.Set(model);
+        bhUniforms.centerPos.Set(glm::vec3(bh.x, bh.y, bh.z));
 
         // Shader expects normalized radii (0 to 1) relative to the quad size (which is size)
         float normInner = (bh.eventHorizonRadius * visualScale) / size; // Should be small
 
-        bhShader->setFloat("innerRadius", normInner);
-        bhShader->setFloat("outerRadius", 1.0f);
+        bhUniforms.innerRadius.Set(normInner);
+        bhUniforms.outerRadius.Set(1.0f);
 
-        glBindVertexArray(bhQuadVAO);
         glDrawArrays(GL_TRIANGLES, 0, 6);
+        GLState::CountDraw();
 	}
-
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
@@ -24,7 +24,7 @@ void generateBlackHoles(std::vector<BlackHole>& blackHoles, const BlackHoleConfi
 void updateBlackHoles(std::vector<BlackHole>& blackHoles, double deltaTime);
 void renderBlackHoles(const std::vector<BlackHole>& blackHoles, const RenderZone& zone, const struct Camera& camera,
     const glm::mat4& view, const glm::mat4& projection,
-    unsigned int noiseTexture, class Shader* bhShader);
+    unsigned int noiseTexture, class Shader* bhShader, float time);
 
 const double SOLAR_MASS_KG = 1.989e30;
 const double SPEED_OF_LIGHT = 2.998e8;
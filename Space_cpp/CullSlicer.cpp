@@ -0,0 +1,52 @@
+#include "CullSlicer.h"
+#include <algorithm>
+#include <cmath>
+
+static int sliceCount = 1;
+
+void CullSlicer::SetSliceCount(int slices) {
+    sliceCount = std::clamp(slices, 1, MAX_SLICES);
+}
+
+int CullSlicer::SliceCount() {
+    return sliceCount;
+}
+
+CullSlicer::~CullSlicer() {
+    Release();
+}
+
+void CullSlicer::Reserve(size_t count) {
+    Release();
+
+    // One bit per particle, at least one word so the binding is never empty
+    size_t words = std::max<size_t>((count + 31) / 32, 1);
+    glCreateBuffers(1, &Buffer);
+    glNamedBufferStorage(Buffer, words * sizeof(unsigned int), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glClearNamedBufferData(Buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+void CullSlicer::Release() {
+    if (Buffer) glDeleteBuffers(1, &Buffer);
+    Buffer = 0;
+    Primed = false;
+}
+
+void CullSlicer::Bind(const Shader& cullShader, bool sliced, double timeStep) {
+    if (SlicesUniform.program != cullShader.ID) {
+        SlicesUniform = cullShader.GetUniform<int>("cullSlices");
+        SliceUniform = cullShader.GetUniform<int>("cullSlice");
+        SliceTimeUniform = cullShader.GetUniform<float>("cullSliceTime");
+    }
+
+    // A full pass writes every bit; slices only reuse bits a full pass has primed
+    int slice = -1;
+    if (sliced && Primed) slice = (int)(Frame++ % sliceCount);
+    Primed = true;
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, Buffer);
+    SlicesUniform.Set(sliceCount);
+    SliceUniform.Set(slice);
+    // Drift is judged over a whole cycle at the current step
+    SliceTimeUniform.Set((float)(std::abs(timeStep) * sliceCount));
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include "Shader.h"
+
+// Temporal slicing of a cull pass (include/cull_slice.glsl). The cull keeps one bit per input
+// particle, set when it rejected the particle (frustum, stochastic LOD) and the particle's
+// orbital drift over a whole cycle stays small as seen from the camera. While only the
+// simulation time advances, such particles are evaluated again in 1 of every SliceCount()
+// frames (slices of 32-particle words, rotating every cull) and skipped without reading
+// their input the rest of the time. Drawn particles, stars feeding the flux image, occluded
+// gas (the occluders move on their own) and near or fast-moving particles are evaluated
+// every frame, so everything on screen still moves every frame.
+//
+// Any other change (camera, projection, render size, quality level, scene) makes the next
+// cull a full pass, which evaluates every particle and rewrites every bit.
+class CullSlicer {
+public:
+    static constexpr int MAX_SLICES = 16;
+
+    // Slices per cycle, shared by every population; 1 disables slicing
+    static void SetSliceCount(int slices);
+    static int SliceCount();
+
+    CullSlicer() = default;
+    ~CullSlicer();
+
+    CullSlicer(const CullSlicer&) = delete;
+    CullSlicer& operator=(const CullSlicer&) = delete;
+
+    // Sizes the bits for `count` input particles; the next cull is a full pass
+    void Reserve(size_t count);
+    void Release();
+
+    // Binds the bits at storage binding 3 and sets the slice uniforms of the cull program.
+    // sliced: the previous cull's inputs only differ in time, timeStep later (simulation time)
+    void Bind(const Shader& cullShader, bool sliced, double timeStep);
+
+private:
+    unsigned int Buffer = 0;
+    bool Primed = false; // Every bit was written since the last Reserve
+    unsigned int Frame = 0;
+
+    // Resolved per cull program
+    Uniform<int> SlicesUniform, SliceUniform;
+    Uniform<float> SliceTimeUniform;
+};
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -13,6 +14,28 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb/stb_truetype.h>
 
+static uint8_t toUnorm8(float value) {
+    return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+static uint16_t toUnorm16(float value) {
+    return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+UIVertex packUIVertex(float x, float y, float u, float v, float r, float g, float b, float a, UIVertexMode mode) {
+    UIVertex vertex = {};
+    vertex.x = (int16_t)std::lround(x);
+    vertex.y = (int16_t)std::lround(y);
+    vertex.u = toUnorm16(u);
+    vertex.v = toUnorm16(v);
+    vertex.r = toUnorm8(r);
+    vertex.g = toUnorm8(g);
+    vertex.b = toUnorm8(b);
+    vertex.a = toUnorm8(a);
+    vertex.mode = mode;
+    return vertex;
+}
+
 namespace FontRenderer {
     static unsigned int fontTexture = 0;
     static stbtt_bakedchar cdata[96]; // ASCII 32..126 is 96 chars
@@ -30,6 +53,8 @@ namespace FontRenderer {
 
         FILE* f = fopen("C:/Windows/Fonts/consola.ttf", "rb");
         if (!f) f = fopen("C:/Windows/Fonts/arial.ttf", "rb");
+        if (!f) f = fopen("/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf", "rb"); // Linux
+        if (!f) f = fopen("/usr/share/fonts/TTF/DejaVuSansMono.ttf", "rb");
         if (!f) {
             std::cerr << "Failed to open font file!" << std::endl;
             return;
@@ -48,7 +73,7 @@ namespace FontRenderer {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
 
-    void appendText(const std::string& text, float x, float y, float scale,
+    void appendText(const char* text, float x, float y, float scale,
         float r, float g, float b, float a,
         std::vector<UIVertex>& buffer) {
 
@@ -56,11 +81,11 @@ namespace FontRenderer {
         float currentY = 0;
         float finalScale = scale * (16.0f / 32.0f);
 
-        for (char c : text) {
-            if (c < 32 || c >= 128) continue;
+        for (const char* c = text; *c; c++) {
+            if (*c < 32 || *c >= 128) continue;
 
             stbtt_aligned_quad q;
-            stbtt_GetBakedQuad(cdata, 1024, 1024, c - 32, &currentX, &currentY, &q, 1);
+            stbtt_GetBakedQuad(cdata, 1024, 1024, *c - 32, &currentX, &currentY, &q, 1);
 
             // Pixel snapping for sharp text
             float x0 = std::floor(x + q.x0 * finalScale + 0.5f);
@@ -69,27 +94,30 @@ namespace FontRenderer {
             float y1 = std::floor(y + q.y1 * finalScale + 0.5f);
 
             // 6 vertices per quad (2 triangles)
-            // Mode 0.0 = Text
+            UIVertex v00 = packUIVertex(x0, y0, q.s0, q.t0, r, g, b, a, UI_MODE_TEXT);
+            UIVertex v01 = packUIVertex(x0, y1, q.s0, q.t1, r, g, b, a, UI_MODE_TEXT);
+            UIVertex v11 = packUIVertex(x1, y1, q.s1, q.t1, r, g, b, a, UI_MODE_TEXT);
+            UIVertex v10 = packUIVertex(x1, y0, q.s1, q.t0, r, g, b, a, UI_MODE_TEXT);
 
             // Triangle 1
-            buffer.push_back({x0, y0, q.s0, q.t0, r, g, b, a, 0.0f});
-            buffer.push_back({x0, y1, q.s0, q.t1, r, g, b, a, 0.0f});
-            buffer.push_back({x1, y1, q.s1, q.t1, r, g, b, a, 0.0f});
+            buffer.push_back(v00);
+            buffer.push_back(v01);
+            buffer.push_back(v11);
 
             // Triangle 2
-            buffer.push_back({x0, y0, q.s0, q.t0, r, g, b, a, 0.0f});
-            buffer.push_back({x1, y1, q.s1, q.t1, r, g, b, a, 0.0f});
-            buffer.push_back({x1, y0, q.s1, q.t0, r, g, b, a, 0.0f});
+            buffer.push_back(v00);
+            buffer.push_back(v11);
+            buffer.push_back(v10);
         }
     }
 
-    float getTextWidth(const std::string& text, float scale) {
+    float getTextWidth(const char* text, float scale) {
         float x = 0;
         float y = 0;
-        for (char c : text) {
-            if (c < 32 || c >= 128) continue;
+        for (const char* c = text; *c; c++) {
+            if (*c < 32 || *c >= 128) continue;
             stbtt_aligned_quad q;
-            stbtt_GetBakedQuad(cdata, 1024, 1024, c - 32, &x, &y, &q, 1);
+            stbtt_GetBakedQuad(cdata, 1024, 1024, *c - 32, &x, &y, &q, 1);
         }
         return x * scale * (16.0f / 32.0f);
     }
@@ -1,23 +1,33 @@
 #pragma once
-#include <string>
+#include <cstdint>
 #include <vector>
 
+enum UIVertexMode : uint8_t {
+    UI_MODE_TEXT = 0, // Font atlas red channel is the alpha
+    UI_MODE_RECT = 1  // Flat color
+};
+
+// 16 bytes: pixel position, unorm16 texture coordinates, RGBA8 color and the mode
 struct UIVertex {
-    float x, y;
-    float u, v;
-    float r, g, b, a;
-    float mode; // 0.0 for Text, 1.0 for Rect
+    int16_t x, y;
+    uint16_t u, v;
+    uint8_t r, g, b, a;
+    uint8_t mode;
+    uint8_t padding[3];
 };
 
+// Packs a vertex: x/y are rounded to whole pixels, u/v and the color are in [0, 1]
+UIVertex packUIVertex(float x, float y, float u, float v, float r, float g, float b, float a, UIVertexMode mode);
+
 namespace FontRenderer {
     void initFont(int screenWidth, int screenHeight);
 
     // Batch mode
-    void appendText(const std::string& text, float x, float y, float scale,
+    void appendText(const char* text, float x, float y, float scale,
         float r, float g, float b, float a,
         std::vector<UIVertex>& buffer);
 
-    float getTextWidth(const std::string& text, float scale);
+    float getTextWidth(const char* text, float scale);
 
     unsigned int getFontTexture();
 
@@ -0,0 +1,350 @@
+#include "FrameCapture.h"
+#include "GLState.h"
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+// Copies a bottom-up RGBA8 readback into a top-down RGB24 image
+static void convertToRGB(const unsigned char* rgba, unsigned int width, unsigned int height, std::vector<unsigned char>& rgb) {
+    rgb.resize((size_t)width * height * 3);
+    for (unsigned int y = 0; y < height; y++) {
+        const unsigned char* src = rgba + (size_t)(height - 1 - y) * width * 4;
+        unsigned char* dst = rgb.data() + (size_t)y * width * 3;
+        for (unsigned int x = 0; x < width; x++) {
+            dst[x * 3 + 0] = src[x * 4 + 0];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+}
+
+// Y4M planes: full-resolution luma followed by two chroma planes at half size (rounded up)
+static size_t yuvFrameSize(unsigned int width, unsigned int height) {
+    size_t chroma = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+    return (size_t)width * height + 2 * chroma;
+}
+
+FrameCapture::FrameCapture(Format format, const std::string& path, double frameRate)
+    : OutputFormat(format), OutputPath(path), FrameRate(frameRate) {
+    unsigned int workerCount = 1;
+
+    if (format == Format::PNG) {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (error) {
+            throw std::runtime_error("FrameCapture: Failed to create directory " + path + ": " + error.message());
+        }
+
+        // PNG encoding is the bottleneck: favour speed over size and spread frames over cores
+        stbi_write_png_compression_level = 1;
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = std::clamp(cores > 1 ? cores - 1 : 1u, 1u, 8u);
+    } else if (path == "-") {
+        // Stream to stdout for an encoder reading a pipe (e.g. ffmpeg -i -)
+        RawFile = stdout;
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else {
+        // Raw frames must stay in order: single writer. Also opens named pipes (blocks until a reader connects)
+        RawFile = fopen(path.c_str(), "wb");
+        if (!RawFile) {
+            throw std::runtime_error("FrameCapture: Failed to open " + path);
+        }
+    }
+
+    if (format == Format::Y4M) {
+        yuvShader = std::make_unique<Shader>("assets/shaders/rgb_to_yuv.comp");
+        yuvShader->GetUniform<int>("sourceTexture").Set(0);
+        YuvSize = yuvShader->GetUniform<glm::ivec2>("size");
+    }
+
+    for (unsigned int i = 0; i < workerCount; i++) {
+        Workers.emplace_back(&FrameCapture::WorkerLoop, this);
+    }
+
+    const char* description = format == Format::PNG ? "PNG sequence to " :
+                              format == Format::Y4M ? "Y4M stream to " : "raw RGB24 frames to ";
+    std::cout << "FrameCapture: Writing " << description << (path == "-" ? "stdout" : path) << " (" << workerCount << " worker" << (workerCount > 1 ? "s" : "") << ")" << std::endl;
+}
+
+FrameCapture::~FrameCapture() {
+    Finish();
+
+    {
+        std::lock_guard<std::mutex> lock(QueueMutex);
+        Stopping = true;
+    }
+    QueueCondition.notify_all();
+    for (auto& worker : Workers) {
+        worker.join();
+    }
+
+    for (auto& slot : Slots) {
+        if (slot.pbo == 0) continue;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ReleasePlanes();
+
+    if (RawFile && RawFile != stdout) {
+        fclose(RawFile);
+    }
+
+    std::cout << "FrameCapture: " << NextFrameIndex << " frames written" << std::endl;
+}
+
+void FrameCapture::AllocateSlot(Slot& slot, size_t size) {
+    if (slot.pbo != 0) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+
+    // Immutable storage mapped once for the lifetime of the slot; client storage keeps it in
+    // system memory where the CPU reads it. Coherent: no explicit barrier before the fence.
+    const GLbitfield mapFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &slot.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, size, nullptr, mapFlags | GL_CLIENT_STORAGE_BIT);
+    slot.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, mapFlags);
+    slot.capacity = size;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::AllocatePlanes(unsigned int width, unsigned int height) {
+    ReleasePlanes();
+
+    unsigned int chromaWidth = (width + 1) / 2;
+    unsigned int chromaHeight = (height + 1) / 2;
+    // Created inside the frame: DSA leaves the texture bindings alone
+    glCreateTextures(GL_TEXTURE_2D, 3, PlaneTextures);
+    for (int i = 0; i < 3; i++) {
+        glTextureStorage2D(PlaneTextures[i], 1, GL_R8, i == 0 ? width : chromaWidth, i == 0 ? height : chromaHeight);
+    }
+
+    PlaneWidth = width;
+    PlaneHeight = height;
+}
+
+void FrameCapture::ReleasePlanes() {
+    if (PlaneTextures[0] == 0) return;
+    glDeleteTextures(3, PlaneTextures);
+    PlaneTextures[0] = PlaneTextures[1] = PlaneTextures[2] = 0;
+    PlaneWidth = PlaneHeight = 0;
+}
+
+void FrameCapture::ReadbackYUV(unsigned int colorTexture, unsigned int width, unsigned int height, size_t size) {
+    if (PlaneWidth != width || PlaneHeight != height) {
+        AllocatePlanes(width, height);
+    }
+
+    // 1. Convert on the GPU: 1.5 bytes per pixel cross the bus instead of 4 (RGBA) or 3 (RGB24)
+    yuvShader->use();
+    YuvSize.Set(glm::ivec2(width, height));
+    GLState::BindTexture(0, colorTexture);
+    for (int i = 0; i < 3; i++) {
+        glBindImageTexture(i, PlaneTextures[i], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    }
+
+    unsigned int chromaWidth = (width + 1) / 2;
+    unsigned int chromaHeight = (height + 1) / 2;
+    glDispatchCompute((chromaWidth + 15) / 16, (chromaHeight + 15) / 16, 1);
+    GLState::CountDispatch();
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+
+    // 2. Pack the planes back to back into the bound PBO
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    size_t offset = 0;
+    for (int i = 0; i < 3; i++) {
+        size_t planeSize = i == 0 ? (size_t)width * height : (size_t)chromaWidth * chromaHeight;
+        glGetTextureImage(PlaneTextures[i], 0, GL_RED, GL_UNSIGNED_BYTE, (GLsizei)(size - offset), (void*)offset);
+        offset += planeSize;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    for (int i = 0; i < 3; i++) {
+        glBindImageTexture(i, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    }
+}
+
+void FrameCapture::Capture(unsigned int fbo, unsigned int colorTexture, unsigned int width, unsigned int height) {
+    if (width == 0 || height == 0) return;
+
+    CollectCompleted(false);
+
+    // Ring full: wait for this slot's GPU copy (the oldest in flight), then for its worker
+    Slot& slot = Slots[NextSlot];
+    while (slot.fence) {
+        CollectCompleted(true);
+    }
+    {
+        std::unique_lock<std::mutex> lock(QueueMutex);
+        SlotReleased.wait(lock, [&slot] { return !slot.busy; });
+    }
+
+    size_t size = OutputFormat == Format::Y4M ? yuvFrameSize(width, height) : (size_t)width * height * 4;
+    if (slot.capacity < size) {
+        AllocateSlot(slot, size);
+    }
+
+    // Async copy into the PBO; returns immediately
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (OutputFormat == Format::Y4M) {
+        ReadbackYUV(colorTexture, width, height, size);
+    } else {
+        GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size = size;
+    slot.frameIndex = NextFrameIndex++;
+    slot.width = width;
+    slot.height = height;
+    {
+        std::lock_guard<std::mutex> lock(QueueMutex);
+        slot.busy = true;
+    }
+
+    InFlight.push_back(NextSlot);
+    NextSlot = (NextSlot + 1) % RING_SIZE;
+}
+
+void FrameCapture::CollectCompleted(bool wait) {
+    // In submission order so raw frames reach the writer in order
+    while (!InFlight.empty()) {
+        int index = InFlight.front();
+        Slot& slot = Slots[index];
+
+        GLenum result = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+        while (wait && result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(slot.fence, 0, 1000000000ull);
+        }
+        if (result == GL_TIMEOUT_EXPIRED) break;
+        if (result == GL_WAIT_FAILED) {
+            std::cerr << "FrameCapture: Fence wait failed, frame " << slot.frameIndex << " may be incomplete" << std::endl;
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        InFlight.pop_front();
+
+        {
+            std::lock_guard<std::mutex> lock(QueueMutex);
+            ReadyQueue.push_back(index);
+            PendingWrites++;
+        }
+        QueueCondition.notify_one();
+
+        // Only block for the oldest frame
+        wait = false;
+    }
+}
+
+void FrameCapture::Finish() {
+    while (!InFlight.empty()) {
+        CollectCompleted(true);
+    }
+
+    std::unique_lock<std::mutex> lock(QueueMutex);
+    SlotReleased.wait(lock, [this] { return PendingWrites == 0; });
+    if (RawFile) {
+        fflush(RawFile);
+    }
+}
+
+void FrameCapture::WorkerLoop() {
+    std::vector<unsigned char> pixels;
+
+    for (;;) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(QueueMutex);
+            QueueCondition.wait(lock, [this] { return Stopping || !ReadyQueue.empty(); });
+            if (ReadyQueue.empty()) return;
+            index = ReadyQueue.front();
+            ReadyQueue.pop_front();
+        }
+
+        // Copy out of the mapped slot first so the render thread can reuse it while we encode
+        Slot& slot = Slots[index];
+        unsigned int frameIndex = slot.frameIndex;
+        unsigned int width = slot.width;
+        unsigned int height = slot.height;
+        if (OutputFormat == Format::Y4M) {
+            pixels.assign(slot.mapped, slot.mapped + slot.size); // Already planar and top-down
+        } else {
+            convertToRGB(slot.mapped, width, height, pixels);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(QueueMutex);
+            slot.busy = false;
+        }
+        SlotReleased.notify_all();
+
+        WriteFrame(frameIndex, width, height, pixels);
+
+        {
+            std::lock_guard<std::mutex> lock(QueueMutex);
+            PendingWrites--;
+        }
+        SlotReleased.notify_all();
+    }
+}
+
+void FrameCapture::WriteFrame(unsigned int frameIndex, unsigned int width, unsigned int height, const std::vector<unsigned char>& pixels) {
+    if (OutputFormat == Format::PNG) {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "frame_%06u.png", frameIndex);
+        std::string filePath = (std::filesystem::path(OutputPath) / fileName).string();
+
+        if (!stbi_write_png(filePath.c_str(), (int)width, (int)height, 3, pixels.data(), (int)width * 3)) {
+            std::cerr << "FrameCapture: Failed to write " << filePath << std::endl;
+        }
+        return;
+    }
+
+    if (OutputFormat == Format::Y4M) {
+        // The stream header fixes the size; the first frame decides it
+        if (!HeaderWritten) {
+            // Integer rates as N:1, otherwise in thousandths (e.g. 30000:1001 ~ 29970:1000)
+            unsigned int numerator = (unsigned int)std::lround(FrameRate * 1000.0);
+            unsigned int denominator = 1000;
+            if (numerator % 1000 == 0) {
+                numerator /= 1000;
+                denominator = 1;
+            }
+            // No field for the matrix: the planes are BT.601 (rgb_to_yuv.comp), what readers assume
+            fprintf(RawFile, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                    width, height, numerator, denominator);
+            StreamWidth = width;
+            StreamHeight = height;
+            HeaderWritten = true;
+        }
+        if (width != StreamWidth || height != StreamHeight) {
+            std::cerr << "FrameCapture: Skipping frame " << frameIndex << " (" << width << "x" << height
+                      << " does not match the " << StreamWidth << "x" << StreamHeight << " stream)" << std::endl;
+            return;
+        }
+        fputs("FRAME\n", RawFile);
+    }
+
+    if (fwrite(pixels.data(), 1, pixels.size(), RawFile) != pixels.size()) {
+        std::cerr << "FrameCapture: Failed to write frame " << frameIndex << std::endl;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include "Shader.h"
+
+// Stall-free readback of the final (tonemapped) frame.
+// Each frame is copied into one of a ring of persistently mapped pixel pack buffers with
+// an async readback and guarded by a fence. Once the fence has signaled, worker threads
+// convert the pixels and write them out (PNG sequence, or a raw RGB24 / Y4M stream to a
+// file, named pipe or stdout), so neither the readback nor the encoding blocks the render thread.
+class FrameCapture {
+public:
+    static constexpr int RING_SIZE = 4;
+
+    enum class Format {
+        PNG,    // <path>/frame_000000.png, encoded on several threads
+        RawRGB, // Consecutive top-down RGB24 frames written in order
+        Y4M     // YUV4MPEG2 4:2:0 stream; converted on the GPU, halving readback vs RGB24
+    };
+
+    // path "-" streams RawRGB / Y4M to stdout. frameRate is written to the Y4M header.
+    // Throws std::runtime_error if the output can't be opened
+    FrameCapture(Format format, const std::string& path, double frameRate = 60.0);
+    ~FrameCapture(); // Flushes outstanding frames
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // True if Capture needs a sampleable color texture (GPU-side YUV conversion)
+    bool NeedsColorTexture() const { return OutputFormat == Format::Y4M; }
+
+    // Queues a readback of the color buffer of fbo (0 = default framebuffer), or of
+    // colorTexture for Y4M. Call after the final composite, before the swap.
+    void Capture(unsigned int fbo, unsigned int colorTexture, unsigned int width, unsigned int height);
+
+    // Waits for all queued frames to be written
+    void Finish();
+
+    unsigned int FramesCaptured() const { return NextFrameIndex; }
+
+private:
+    struct Slot {
+        unsigned int pbo = 0;
+        unsigned char* mapped = nullptr; // Persistent, coherent mapping
+        size_t capacity = 0;
+        size_t size = 0;                 // Bytes of the queued frame
+        GLsync fence = nullptr;          // Pending GPU copy
+        bool busy = false;               // Owned by the GPU or a worker until released
+        unsigned int frameIndex = 0;
+        unsigned int width = 0, height = 0;
+    };
+
+    Format OutputFormat;
+    std::string OutputPath;
+    double FrameRate;
+    FILE* RawFile = nullptr;
+    bool HeaderWritten = false;
+    unsigned int StreamWidth = 0, StreamHeight = 0; // Y4M stream size (fixed by the header)
+
+    // GPU RGB -> YUV conversion (Y4M)
+    std::unique_ptr<Shader> yuvShader;
+    Uniform<glm::ivec2> YuvSize;
+    unsigned int PlaneTextures[3] = { 0, 0, 0 }; // Y, Cb, Cr (R8)
+    unsigned int PlaneWidth = 0, PlaneHeight = 0;
+
+    Slot Slots[RING_SIZE];
+    int NextSlot = 0;
+    unsigned int NextFrameIndex = 0;
+    std::deque<int> InFlight; // Slots with a pending fence, oldest first
+
+    // Worker queue (slots whose pixels are ready)
+    std::vector<std::thread> Workers;
+    std::deque<int> ReadyQueue;
+    std::mutex QueueMutex;
+    std::condition_variable QueueCondition; // Work available / stopping
+    std::condition_variable SlotReleased;   // A worker finished with a slot or a write
+    unsigned int PendingWrites = 0;         // Frames handed to workers and not yet written
+    bool Stopping = false;
+
+    void AllocateSlot(Slot& slot, size_t size);
+    void AllocatePlanes(unsigned int width, unsigned int height);
+    void ReleasePlanes();
+    // Converts colorTexture to YUV planes and reads them into the bound pixel pack buffer
+    void ReadbackYUV(unsigned int colorTexture, unsigned int width, unsigned int height, size_t size);
+    // Hands slots whose fence has signaled to the workers; blocks on the oldest if wait is set
+    void CollectCompleted(bool wait);
+    void WorkerLoop();
+    void WriteFrame(unsigned int frameIndex, unsigned int width, unsigned int height, const std::vector<unsigned char>& pixels);
+};
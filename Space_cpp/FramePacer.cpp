@@ -0,0 +1,42 @@
+#include "FramePacer.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <thread>
+
+FramePacer::FramePacer(double maxFps, double backgroundFps)
+    : MaxFps(maxFps), BackgroundFps(backgroundFps) {
+}
+
+static bool isHidden(GLFWwindow* window) {
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    return glfwGetWindowAttrib(window, GLFW_ICONIFIED) || width == 0 || height == 0;
+}
+
+bool FramePacer::WaitWhileHidden(GLFWwindow* window) {
+    bool waited = false;
+    while (isHidden(window) && !glfwWindowShouldClose(window)) {
+        glfwWaitEvents();
+        waited = true;
+    }
+    if (waited) LastFrameTime = glfwGetTime();
+    return waited;
+}
+
+void FramePacer::EndFrame(GLFWwindow* window, bool idle) {
+    // 1. Frame cap. Sleeps rather than waiting on events, which would let every mouse move
+    //    start the next frame early
+    double fps = glfwGetWindowAttrib(window, GLFW_FOCUSED) ? MaxFps : BackgroundFps;
+    if (fps > 0.0) {
+        double remaining = LastFrameTime + 1.0 / fps - glfwGetTime();
+        if (remaining > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+    }
+    LastFrameTime = glfwGetTime();
+
+    // 2. Events: nothing to animate while idle, so only input (or the timeout) starts a frame
+    if (idle) {
+        glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+    } else {
+        glfwPollEvents();
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+struct GLFWwindow;
+
+// Power and throughput policy of the windowed render loop, so that instances sharing a
+// machine don't keep its GPU busy with frames nobody needs:
+//   - Frame rate cap: MaxFps while focused, BackgroundFps while another window has focus
+//   - Idle (the frame reused the cached scene: paused with a still camera): the loop blocks
+//     in glfwWaitEventsTimeout instead of polling. Input wakes it at once; the timeout keeps
+//     the overlay's counters and debounced resizes going
+//   - Minimized: nothing is rendered until the window is restored
+// Captures bypass it (main.cpp): they need every frame as fast as it comes.
+class FramePacer {
+public:
+    static constexpr double IDLE_WAIT_SECONDS = 0.25;
+
+    // Caps in frames per second; <= 0 leaves that state uncapped
+    FramePacer(double maxFps, double backgroundFps);
+
+    // Blocks while the window is minimized (or its framebuffer is empty). True if it waited:
+    // the caller restarts its frame clock rather than simulating the time away
+    bool WaitWhileHidden(GLFWwindow* window);
+
+    // Call after the swap: sleeps off the rest of the frame period, then polls for events,
+    // or waits for them if the frame was idle
+    void EndFrame(GLFWwindow* window, bool idle);
+
+private:
+    double MaxFps;
+    double BackgroundFps;
+    double LastFrameTime = 0.0; // When the previous frame was released (glfwGetTime)
+};
@@ -0,0 +1,117 @@
+#include "FrameRing.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+std::unique_ptr<FrameRing> g_frameRing;
+
+FrameRing::FrameRing(size_t sliceSize) : SliceSize(sliceSize) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) UniformOffsetAlignment = (size_t)alignment;
+    alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) StorageOffsetAlignment = (size_t)alignment;
+
+    // Immutable storage mapped once; coherent, so writes are visible without a flush
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &RingBuffer);
+    glNamedBufferStorage(RingBuffer, SliceSize * FRAME_COUNT, nullptr, mapFlags);
+    Mapped = (unsigned char*)glMapNamedBufferRange(RingBuffer, 0, SliceSize * FRAME_COUNT, mapFlags);
+    if (!Mapped) {
+        glDeleteBuffers(1, &RingBuffer);
+        throw std::runtime_error("FrameRing: Failed to map the ring buffer");
+    }
+}
+
+FrameRing::~FrameRing() {
+    for (GLsync& fence : Fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (RingBuffer != 0) {
+        glUnmapNamedBuffer(RingBuffer);
+        glDeleteBuffers(1, &RingBuffer);
+        RingBuffer = 0;
+    }
+}
+
+void FrameRing::BeginFrame() {
+    if (FrameActive) EndFrame();
+
+    CurrentSlice = (CurrentSlice + 1) % FRAME_COUNT;
+    SliceOffset = 0;
+    FrameActive = true;
+
+    // The slice was last used FRAME_COUNT frames ago; normally its fence has long signaled
+    GLsync& fence = Fences[CurrentSlice];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 s
+    }
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "FrameRing: Fence wait failed" << std::endl;
+        glFinish();
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FrameRing::EndFrame() {
+    if (!FrameActive) return;
+    Fences[CurrentSlice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    FrameActive = false;
+}
+
+FrameRing::Allocation FrameRing::Allocate(size_t size, size_t alignment) {
+    Allocation allocation;
+    if (!FrameActive) return allocation;
+
+    size_t offset = (SliceOffset + alignment - 1) / alignment * alignment;
+    if (offset + size > SliceSize) return allocation;
+
+    SliceOffset = offset + size;
+    allocation.offset = (GLintptr)(CurrentSlice * SliceSize + offset);
+    allocation.data = Mapped + allocation.offset;
+    return allocation;
+}
+
+void uploadFrameData(unsigned int buffer, GLintptr offset, const void* data, size_t size) {
+    FrameRing::Allocation allocation;
+    if (g_frameRing) allocation = g_frameRing->Allocate(size, 4);
+
+    if (allocation.data) {
+        memcpy(allocation.data, data, size);
+        glCopyNamedBufferSubData(g_frameRing->Buffer(), buffer, allocation.offset, offset, size);
+    } else {
+        glNamedBufferSubData(buffer, offset, size, data);
+    }
+}
+
+void bindFrameUniforms(unsigned int bindingPoint, unsigned int fallbackUBO, const void* data, size_t size) {
+    FrameRing::Allocation allocation;
+    if (g_frameRing) allocation = g_frameRing->Allocate(size, g_frameRing->UniformAlignment());
+
+    if (allocation.data) {
+        memcpy(allocation.data, data, size);
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, g_frameRing->Buffer(), allocation.offset, size);
+    } else {
+        glNamedBufferSubData(fallbackUBO, 0, size, data);
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, fallbackUBO);
+    }
+}
+
+void bindFrameStorage(unsigned int bindingPoint, unsigned int fallbackSSBO, const void* data, size_t size) {
+    FrameRing::Allocation allocation;
+    if (g_frameRing) allocation = g_frameRing->Allocate(size, g_frameRing->StorageAlignment());
+
+    if (allocation.data) {
+        memcpy(allocation.data, data, size);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingPoint, g_frameRing->Buffer(), allocation.offset, size);
+    } else {
+        glNamedBufferData(fallbackSSBO, size, data, GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, fallbackSSBO);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <glad/glad.h>
+#include <memory>
+
+// Per-frame dynamic data (uniform blocks, the UI vertex stream, indirect command resets) is
+// written into one persistently mapped buffer split into FRAME_COUNT slices, one per frame in
+// flight. A fence guards each slice, so the CPU never overwrites data the GPU may still read
+// and the driver never has to synchronize or rename a buffer behind glBufferSubData.
+class FrameRing {
+public:
+    static constexpr int FRAME_COUNT = 3;
+
+    struct Allocation {
+        void* data = nullptr; // Write-only, coherent mapping; nullptr if the slice is full
+        GLintptr offset = 0;  // Offset in Buffer()
+    };
+
+    // sliceSize: bytes available to each frame
+    explicit FrameRing(size_t sliceSize);
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Moves to the next slice, waiting for the GPU if it's still reading it from FRAME_COUNT frames ago
+    void BeginFrame();
+    // Fences the slice after the last command of the frame that reads it
+    void EndFrame();
+
+    Allocation Allocate(size_t size, size_t alignment = 16);
+
+    unsigned int Buffer() const { return RingBuffer; }
+    size_t UniformAlignment() const { return UniformOffsetAlignment; }
+    size_t StorageAlignment() const { return StorageOffsetAlignment; }
+
+private:
+    unsigned int RingBuffer = 0;
+    unsigned char* Mapped = nullptr;
+    size_t SliceSize;
+    size_t UniformOffsetAlignment = 256;
+    size_t StorageOffsetAlignment = 256;
+
+    GLsync Fences[FRAME_COUNT] = {};
+    int CurrentSlice = FRAME_COUNT - 1;
+    size_t SliceOffset = 0;
+    bool FrameActive = false;
+};
+
+// Created by main after the context; null in contexts that don't stream through the ring
+extern std::unique_ptr<FrameRing> g_frameRing;
+
+// Writes size bytes at offset of buffer through the ring (a GPU-side copy ordered with the
+// frame's other commands), or with glNamedBufferSubData if there is no ring or it is full
+void uploadFrameData(unsigned int buffer, GLintptr offset, const void* data, size_t size);
+
+// Binds size bytes of data to a uniform block binding point, from the ring or, as a fallback,
+// written into fallbackUBO
+void bindFrameUniforms(unsigned int bindingPoint, unsigned int fallbackUBO, const void* data, size_t size);
+
+// Same for a shader storage binding (per-frame instance data); fallbackSSBO is respecified to size
+void bindFrameStorage(unsigned int bindingPoint, unsigned int fallbackSSBO, const void* data, size_t size);
@@ -0,0 +1,157 @@
+#include "GLState.h"
+
+static const unsigned int UNKNOWN_NAME = ~0u;
+static const GLenum UNKNOWN_ENUM = ~0u;
+static const int UNKNOWN_FLAG = -1;
+
+static const GLenum trackedCaps[] = { GL_BLEND, GL_DEPTH_TEST, GL_PROGRAM_POINT_SIZE, GL_CULL_FACE, GL_SCISSOR_TEST };
+static const int TRACKED_CAP_COUNT = sizeof(trackedCaps) / sizeof(trackedCaps[0]);
+static const unsigned int TRACKED_TEXTURE_UNITS = 16;
+
+// Every value starts unknown, so the first change after Reset() is issued
+struct ShadowState {
+    int capEnabled[TRACKED_CAP_COUNT];
+    GLenum blendSrc = UNKNOWN_ENUM, blendDst = UNKNOWN_ENUM;
+    int depthMask = UNKNOWN_FLAG;
+    unsigned int program = UNKNOWN_NAME;
+    unsigned int vao = UNKNOWN_NAME;
+    unsigned int textures[TRACKED_TEXTURE_UNITS];
+    unsigned int readFramebuffer = UNKNOWN_NAME, drawFramebuffer = UNKNOWN_NAME;
+
+    ShadowState() {
+        for (int& enabled : capEnabled) enabled = UNKNOWN_FLAG;
+        for (unsigned int& texture : textures) texture = UNKNOWN_NAME;
+    }
+};
+
+static ShadowState shadow;
+static GLState::Counters frameCounters;
+static GLState::Counters lastFrameCounters;
+
+static int capIndex(GLenum cap) {
+    for (int i = 0; i < TRACKED_CAP_COUNT; i++) {
+        if (trackedCaps[i] == cap) return i;
+    }
+    return -1;
+}
+
+// True if the call has to be issued; updates the shadow value and the counters
+template<typename T>
+static bool changes(T& current, T value) {
+    if (current == value) {
+        frameCounters.stateChangesFiltered++;
+        return false;
+    }
+    current = value;
+    frameCounters.stateChanges++;
+    return true;
+}
+
+GLState::Counters& GLState::Counters::operator+=(const Counters& other) {
+    drawCalls += other.drawCalls;
+    dispatches += other.dispatches;
+    programSwitches += other.programSwitches;
+    framebufferBinds += other.framebufferBinds;
+    stateChanges += other.stateChanges;
+    stateChangesFiltered += other.stateChangesFiltered;
+    return *this;
+}
+
+void GLState::BeginFrame() {
+    Reset();
+    frameCounters = Counters();
+}
+
+void GLState::EndFrame() {
+    lastFrameCounters = frameCounters;
+}
+
+void GLState::Reset() {
+    shadow = ShadowState();
+}
+
+const GLState::Counters& GLState::LastFrame() {
+    return lastFrameCounters;
+}
+
+void GLState::Enable(GLenum cap) {
+    int index = capIndex(cap);
+    if (index < 0) {
+        frameCounters.stateChanges++;
+        glEnable(cap);
+    } else if (changes(shadow.capEnabled[index], 1)) {
+        glEnable(cap);
+    }
+}
+
+void GLState::Disable(GLenum cap) {
+    int index = capIndex(cap);
+    if (index < 0) {
+        frameCounters.stateChanges++;
+        glDisable(cap);
+    } else if (changes(shadow.capEnabled[index], 0)) {
+        glDisable(cap);
+    }
+}
+
+void GLState::BlendFunc(GLenum src, GLenum dst) {
+    if (shadow.blendSrc == src && shadow.blendDst == dst) {
+        frameCounters.stateChangesFiltered++;
+        return;
+    }
+    shadow.blendSrc = src;
+    shadow.blendDst = dst;
+    frameCounters.stateChanges++;
+    glBlendFunc(src, dst);
+}
+
+void GLState::DepthMask(GLboolean mask) {
+    if (changes(shadow.depthMask, mask ? 1 : 0)) glDepthMask(mask);
+}
+
+void GLState::UseProgram(unsigned int program) {
+    if (!changes(shadow.program, program)) return;
+    frameCounters.programSwitches++;
+    glUseProgram(program);
+}
+
+void GLState::BindVertexArray(unsigned int vao) {
+    if (changes(shadow.vao, vao)) glBindVertexArray(vao);
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int texture) {
+    if (unit >= TRACKED_TEXTURE_UNITS) {
+        frameCounters.stateChanges++;
+        glBindTextureUnit(unit, texture);
+    } else if (changes(shadow.textures[unit], texture)) {
+        glBindTextureUnit(unit, texture);
+    }
+}
+
+void GLState::BindFramebuffer(GLenum target, unsigned int fbo) {
+    bool bindRead = target != GL_DRAW_FRAMEBUFFER && shadow.readFramebuffer != fbo;
+    bool bindDraw = target != GL_READ_FRAMEBUFFER && shadow.drawFramebuffer != fbo;
+    if (!bindRead && !bindDraw) {
+        frameCounters.stateChangesFiltered++;
+        return;
+    }
+
+    // Only the half that differs is rebound
+    if (bindRead && bindDraw) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    } else {
+        glBindFramebuffer(bindRead ? GL_READ_FRAMEBUFFER : GL_DRAW_FRAMEBUFFER, fbo);
+    }
+    if (bindRead) shadow.readFramebuffer = fbo;
+    if (bindDraw) shadow.drawFramebuffer = fbo;
+    frameCounters.stateChanges++;
+    frameCounters.framebufferBinds++;
+}
+
+void GLState::CountDraw() {
+    frameCounters.drawCalls++;
+}
+
+void GLState::CountDispatch() {
+    frameCounters.dispatches++;
+}
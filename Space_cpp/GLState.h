@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+
+// Shadow copy of the GL state the per-frame passes change (capabilities, blending, depth
+// writes, program, VAO, texture units, framebuffers). A call that would set the value
+// already in place is dropped before it reaches the driver, so each pass can simply state
+// what it needs instead of restoring defaults for the next one.
+//
+// Per-frame code binds this state only through GLState. Init code (between frames) may
+// use raw GL: BeginFrame forgets the shadow, so the first change of each frame is always
+// issued. Code that deletes bound objects inside a frame calls Reset() afterwards.
+//
+// Every frame also counts draws, dispatches, program switches, framebuffer binds and
+// state changes issued vs. filtered, shown in the UI and the headless summary.
+class GLState {
+public:
+    struct Counters {
+        unsigned int drawCalls = 0;
+        unsigned int dispatches = 0;
+        unsigned int programSwitches = 0;
+        unsigned int framebufferBinds = 0;
+        unsigned int stateChanges = 0;         // Issued (includes program and framebuffer binds)
+        unsigned int stateChangesFiltered = 0; // Dropped as redundant
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    // Forgets the shadow and starts the frame's counters
+    static void BeginFrame();
+    // Publishes the frame's counters to LastFrame()
+    static void EndFrame();
+    // Forgets the shadow: the next change of every state is issued
+    static void Reset();
+
+    static const Counters& LastFrame();
+
+    // GL_BLEND, GL_DEPTH_TEST, GL_PROGRAM_POINT_SIZE, GL_CULL_FACE and GL_SCISSOR_TEST are
+    // tracked; other capabilities are always issued
+    static void Enable(GLenum cap);
+    static void Disable(GLenum cap);
+    static void BlendFunc(GLenum src, GLenum dst);
+    static void DepthMask(GLboolean mask);
+
+    static void UseProgram(unsigned int program);
+    static void BindVertexArray(unsigned int vao);
+    // glBindTextureUnit: binds to the texture's own target, without touching the active unit
+    static void BindTexture(unsigned int unit, unsigned int texture);
+    // GL_FRAMEBUFFER binds both the read and draw framebuffer
+    static void BindFramebuffer(GLenum target, unsigned int fbo);
+
+    // Called next to each glDraw* / glDispatchCompute*
+    static void CountDraw();
+    static void CountDispatch();
+};
@@ -1,6 +1,10 @@
 #include "GalacticGas.h"
 #include "SolarSystem.h"
 #include "Shader.h"
+#include "GLState.h"
+#include "RenderInputs.h"
+#include "SpriteArena.h"
+#include "CullSlicer.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
@@ -8,8 +12,6 @@
 #include <random>
 #include <vector>
 #include <memory>
-#include <fstream>
-#include <sstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/packing.hpp>
 
@@ -18,135 +20,82 @@
 #endif
 
 // GPU Resources Container
+// Culled clouds go to the population's range of the shared SpriteArena
 struct GasResources {
     unsigned int inputSSBO = 0;
-    unsigned int outputSSBO = 0;
-    unsigned int indirectBuffer = 0;
-    unsigned int vao = 0; // Empty VAO, VBO is the Output SSBO
-    size_t capacity = 0;
+    SpriteRange range;
     size_t count = 0;
+    CullSlicer slicer; // Rejections reused between culls while only time advances
 };
 
-static GasResources darkGasRes;
-static GasResources lumGasRes;
-
-static unsigned int computeProgram = 0;
-static size_t lastDarkCount = 0;
-static size_t lastLuminousCount = 0;
-
-struct DrawCommand {
-    unsigned int count;
-    unsigned int instanceCount;
-    unsigned int first;
-    unsigned int baseInstance;
+static GasResources darkGasRes = { 0, SPRITE_DARK_GAS, 0, {} };
+static GasResources lumGasRes = { 0, SPRITE_LUMINOUS_GAS, 0, {} };
+
+static std::unique_ptr<Shader> gasCullShader; // Compute
+static Uniform<int> gasCullRange;
+static bool gasCullInitAttempted = false;
+
+// Uniform handles of the dark / luminous gas programs, resolved once per program
+struct GasDrawUniforms {
+    unsigned int program = 0;
+    Uniform<float> resolutionScale;
+    Uniform<float> pointMultiplier;
+    Uniform<int> depthMap;
+    Uniform<int> quarterResLinearDepth;
+    Uniform<float> softnessScale;
+
+    void Resolve(const Shader& shader) {
+        if (program == shader.ID) return;
+        program = shader.ID;
+        resolutionScale = shader.GetUniform<float>("resolutionScale");
+        pointMultiplier = shader.GetUniform<float>("pointMultiplier");
+        depthMap = shader.GetUniform<int>("depthMap");
+        quarterResLinearDepth = shader.GetUniform<int>("quarterResLinearDepth");
+        softnessScale = shader.GetUniform<float>("softnessScale");
+    }
 };
+static GasDrawUniforms darkGasUniforms;
+static GasDrawUniforms lumGasUniforms;
+static unsigned int uploadedSceneVersion = ~0u;
+static RenderInputs gasCullInputs; // Inputs the compacted clouds in the arena were culled with
+static unsigned int gasCullLayout = 0; // SpriteArena layout they were written to
+static bool gasCullValid = false;
 
 struct Color4 {
     float r, g, b, a;
 };
 
 // --- Shader Management ---
-static void checkCompileErrors(unsigned int shader, std::string type) {
-    int success;
-    char infoLog[1024];
-    if (type != "PROGRAM") {
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            std::cerr << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-        }
-    } else {
-        glGetProgramiv(shader, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-            std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-        }
-    }
-}
-
 static void initCompute() {
-    if (computeProgram != 0) return;
-
-    std::string code;
-    std::ifstream file("assets/shaders/gas_cull.comp");
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Could not open assets/shaders/gas_cull.comp" << std::endl;
-        return;
+    if (gasCullInitAttempted) return;
+    gasCullInitAttempted = true;
+
+    try {
+        gasCullShader = std::make_unique<Shader>("assets/shaders/gas_cull.comp", SpriteArena::CullDefines());
+        // Screen size and point scale come from the FrameParams block
+        gasCullShader->GetUniform<int>("depthMap").Set(0);
+        gasCullRange = gasCullShader->GetUniform<int>("spriteRange");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
     }
-    std::stringstream ss;
-    ss << file.rdbuf();
-    code = ss.str();
-    const char* cCode = code.c_str();
-
-    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(shader, 1, &cCode, NULL);
-    glCompileShader(shader);
-    checkCompileErrors(shader, "COMPUTE");
-
-    computeProgram = glCreateProgram();
-    glAttachShader(computeProgram, shader);
-    glLinkProgram(computeProgram);
-    checkCompileErrors(computeProgram, "PROGRAM");
-    glDeleteShader(shader);
 }
 
 static void initGasResources(GasResources& res) {
-    if (res.vao != 0) return;
-
+    if (res.inputSSBO != 0) return;
     glGenBuffers(1, &res.inputSSBO);
-    glGenBuffers(1, &res.outputSSBO);
-    glGenBuffers(1, &res.indirectBuffer);
-
-    glGenVertexArrays(1, &res.vao);
-    glBindVertexArray(res.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, res.outputSSBO);
-
-    // Layout matches Packed GasRender struct in shader (20 bytes total)
-    // struct GasRender {
-    //     float px, py, pz; // 12 bytes
-    //     uint color;       // 4 bytes
-    //     float size;       // 4 bytes
-    // };
-
-    const int STRIDE = 20;
-
-    // Attrib 0: Pos (vec3) - from px, py, pz (Offset 0)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, STRIDE, (void*)0);
-
-    // Attrib 1: Color (vec4) - Unpack from uint (GL_UNSIGNED_BYTE, normalized = TRUE)
-    // Source is at offset 12 (after pos)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, STRIDE, (void*)12);
-
-    // Attrib 2: Size (float) - offset 16 (after color)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, STRIDE, (void*)16);
-
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // Init Indirect Buffer
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, res.indirectBuffer);
-    DrawCommand cmd = {0, 1, 0, 0};
-    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawCommand), &cmd, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 static void uploadGasData(GasResources& res, const std::vector<GasVertex>& vertices) {
-    if (vertices.empty()) return;
     res.count = vertices.size();
 
-    // 1. Upload Input (Static)
+    // 1. Reserve Output (12 bytes per cloud (Packed SpriteRender) in the sprite arena)
+    SpriteArena::Reserve(res.range, vertices.size());
+    res.slicer.Reserve(vertices.size());
+    if (vertices.empty()) return;
+
+    // 2. Upload Input (Static)
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, res.inputSSBO);
     glBufferData(GL_SHADER_STORAGE_BUFFER, vertices.size() * sizeof(GasVertex), vertices.data(), GL_STATIC_DRAW);
-
-    // 2. Allocate Output (Dynamic)
-    // 20 bytes per vertex (Packed GasRender)
-    size_t outputSize = vertices.size() * 20;
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, res.outputSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, outputSize, NULL, GL_DYNAMIC_DRAW);
-
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
@@ -381,55 +330,59 @@ void generateGalacticGas(std::vector<GasVertex>& darkVertices, std::vector<GasVe
 }
 
 void prepareGalacticGas(const std::vector<GasVertex>& darkVertices, const std::vector<GasVertex>& luminousVertices,
-                        float time, unsigned int depthTexture, float screenWidth, float screenHeight,
+                        float time, unsigned int depthTexture,
                         const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection) {
     // Init resources if needed
     initCompute();
+    if (!gasCullShader) return;
     initGasResources(darkGasRes);
     initGasResources(lumGasRes);
 
     // Check for updates
-    if (darkVertices.size() != lastDarkCount) {
+    // Keyed on the scene version, so a regeneration with the same cloud counts is uploaded too
+    if (g_renderInputs.sceneVersion != uploadedSceneVersion) {
         uploadGasData(darkGasRes, darkVertices);
-        lastDarkCount = darkVertices.size();
-    }
-    if (luminousVertices.size() != lastLuminousCount) {
         uploadGasData(lumGasRes, luminousVertices);
-        lastLuminousCount = luminousVertices.size();
+        uploadedSceneVersion = g_renderInputs.sceneVersion;
+        gasCullValid = false;
     }
 
+    // Culling also reads the depth buffer and the render size: the last result stands only
+    // while every input matches
+    if (gasCullValid && gasCullLayout == SpriteArena::LayoutVersion() && g_renderInputs == gasCullInputs) return;
+
+    // While only time moved since the last cull, its rejections are reused in all but one slice
+    bool sliced = gasCullValid && gasCullLayout == SpriteArena::LayoutVersion() &&
+                  g_renderInputs.SameExceptTime(gasCullInputs);
+    double timeStep = gasCullInputs.time >= 0.0 ? g_renderInputs.time - gasCullInputs.time : 0.0;
+    gasCullInputs = g_renderInputs;
+    gasCullLayout = SpriteArena::LayoutVersion();
+    gasCullValid = true;
+
     // --- Compute Pass ---
-    glUseProgram(computeProgram);
-    glUniform1f(glGetUniformLocation(computeProgram, "pointScale"), 200.0f);
+    gasCullShader->use();
 
     // Bind Depth Map for Occlusion Culling
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, depthTexture);
-    glUniform1i(glGetUniformLocation(computeProgram, "depthMap"), 0);
+    GLState::BindTexture(0, depthTexture);
 
-    // Uniforms for Coordinate Conversion & Stochastic LOD
-    glUniform1f(glGetUniformLocation(computeProgram, "screenWidth"), screenWidth);
-    glUniform1f(glGetUniformLocation(computeProgram, "screenHeight"), screenHeight);
-    glUniform1f(glGetUniformLocation(computeProgram, "zNear"), 0.1f);
-    glUniform1f(glGetUniformLocation(computeProgram, "zFar"), 20000.0f);
+    // One bind covers both ranges, the spriteRange uniform selects the one appended to
+    SpriteArena::BindForCull();
+    SpriteArena::ResetCounts(SPRITE_DARK_GAS, 2);
 
-    auto dispatchBatch = [](GasResources& res) {
+    auto dispatchBatch = [sliced, timeStep](GasResources& res) {
         if (res.count == 0) return;
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, res.inputSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, res.outputSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, res.indirectBuffer);
-
-        DrawCommand resetCmd = {0, 1, 0, 0};
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, res.indirectBuffer);
-        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawCommand), &resetCmd);
+        gasCullRange.Set((int)res.range);
+        res.slicer.Bind(*gasCullShader, sliced, timeStep);
 
         glDispatchCompute((unsigned int)((res.count + 255) / 256), 1, 1);
+        GLState::CountDispatch();
     };
 
     dispatchBatch(darkGasRes);
     dispatchBatch(lumGasRes);
 
-    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 void drawDarkGas(Shader* gasShader, const glm::mat4& view, const glm::mat4& projection, float time, unsigned int depthTexture) {
@@ -437,90 +390,70 @@ void drawDarkGas(Shader* gasShader, const glm::mat4& view, const glm::mat4& proj
 
     // --- Render Pass ---
     gasShader->use();
-    gasShader->setFloat("u_Time", time);
-    gasShader->setFloat("resolutionScale", 1.0f); // Always full res for dark gas
-    gasShader->setFloat("pointMultiplier", 1.0f); // Full resolution size
+    const GasDrawUniforms& u = darkGasUniforms;
+    darkGasUniforms.Resolve(*gasShader);
+    u.resolutionScale.Set(1.0f); // Always full res for dark gas
+    u.pointMultiplier.Set(1.0f); // Full resolution size
 
     // Bind Depth Map for Soft Particles
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, depthTexture);
-    gasShader->setInt("depthMap", 1);
-    gasShader->setFloat("zNear", 0.1f);
-    gasShader->setFloat("zFar", 20000.0f);
-    gasShader->setFloat("softnessScale", 0.05f); // 1.0 / 20.0 units
-
-    glEnable(GL_BLEND);
+    GLState::BindTexture(1, depthTexture);
+    u.depthMap.Set(1);
+    u.softnessScale.Set(0.05f); // 1.0 / 20.0 units
+
+    GLState::Enable(GL_BLEND);
     // Enable Depth Testing so particles are correctly occluded by opaque objects (planets/stars)
-    glEnable(GL_DEPTH_TEST);
+    GLState::Enable(GL_DEPTH_TEST);
     // Disable Depth Writing so transparent particles don't occlude each other or the background
-    glDepthMask(GL_FALSE);
-    glEnable(GL_PROGRAM_POINT_SIZE);
+    GLState::DepthMask(GL_FALSE);
+    GLState::Enable(GL_PROGRAM_POINT_SIZE);
 
     // Render Dark Lanes (Occlusion/Absorption)
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindVertexArray(darkGasRes.vao);
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, darkGasRes.indirectBuffer);
-    glDrawArraysIndirect(GL_POINTS, 0);
-
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
-    glBindVertexArray(0);
-    glDepthMask(GL_TRUE);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    SpriteArena::Draw(darkGasRes.range);
 }
 
-void drawLuminousGas(Shader* gasShader, const glm::mat4& view, const glm::mat4& projection, float time, unsigned int depthTexture, bool quarterRes) {
+void drawLuminousGas(Shader* gasShader, const glm::mat4& view, const glm::mat4& projection, float time, unsigned int depthTexture, float resolutionScale) {
     if (lumGasRes.count == 0) return;
 
     gasShader->use();
-    gasShader->setFloat("u_Time", time);
-
-    // If quarterRes is true, we need to scale gl_FragCoord in the shader to sample the full-res depth map correctly
-    // Low-Res path uses Quarter-Res (4.0 scale)
-    if (!quarterRes) {
-        gasShader->setFloat("resolutionScale", 1.0f);
+    const GasDrawUniforms& u = lumGasUniforms;
+    lumGasUniforms.Resolve(*gasShader);
+
+    // The low-res path (resolutionScale < 1, the PostProcessor's gas resolution) reads the
+    // low-res depth at gl_FragCoord directly; the full-res one reads the full-res linear depth
+    bool lowRes = resolutionScale < 1.0f;
+    if (!lowRes) {
+        u.resolutionScale.Set(1.0f);
     }
-    // Scale points down by 0.25 if rendering to quarter-res buffer to preserve screen coverage ratio and reduce fill rate
-    gasShader->setFloat("pointMultiplier", quarterRes ? 0.25f : 1.0f);
+    // Scale points down with the target to preserve screen coverage ratio and reduce fill rate
+    u.pointMultiplier.Set(resolutionScale);
 
     // Bind Depth Map for Soft Particles
-    if (!quarterRes) {
+    if (!lowRes) {
         // Full Res: Use Hardware Depth Test + Manual Softness Read
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, depthTexture);
-        gasShader->setInt("depthMap", 1);
+        GLState::BindTexture(1, depthTexture);
+        u.depthMap.Set(1);
 
-        glEnable(GL_DEPTH_TEST);
+        GLState::Enable(GL_DEPTH_TEST);
     } else {
-        // Quarter Res: Disable Hardware Depth Test
+        // Low Res: Disable Hardware Depth Test
         // We are rendering to an offscreen buffer with NO depth attachment.
         // Depth testing is done manually in the pixel shader against the downsampled depth texture.
-        glDisable(GL_DEPTH_TEST);
+        GLState::Disable(GL_DEPTH_TEST);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, depthTexture);
-        gasShader->setInt("quarterResLinearDepth", 0);
+        GLState::BindTexture(0, depthTexture);
+        u.quarterResLinearDepth.Set(0);
     }
 
-    if (!quarterRes) {
-        gasShader->setFloat("zNear", 0.1f);
-        gasShader->setFloat("zFar", 20000.0f);
-    }
-    gasShader->setFloat("softnessScale", 0.05f);
+    u.softnessScale.Set(0.05f);
 
-    glEnable(GL_BLEND);
-    glDepthMask(GL_FALSE);
-    glEnable(GL_PROGRAM_POINT_SIZE);
+    GLState::Enable(GL_BLEND);
+    GLState::DepthMask(GL_FALSE);
+    GLState::Enable(GL_PROGRAM_POINT_SIZE);
 
     // Render Luminous (Additive/Emission)
-    // For Quarter-Res R11G11B10F, we accumulate light: SrcRGB * SrcAlpha + DstRGB
+    // For Low-Res R11G11B10F, we accumulate light: SrcRGB * SrcAlpha + DstRGB
     // This works perfectly as the buffer has no alpha to mess up.
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    glBindVertexArray(lumGasRes.vao);
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, lumGasRes.indirectBuffer);
-    glDrawArraysIndirect(GL_POINTS, 0);
-
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
-    glBindVertexArray(0);
-    glDepthMask(GL_TRUE);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+    SpriteArena::Draw(lumGasRes.range);
 }
@@ -2,6 +2,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "FrameRing.h"
 
 struct GlobalUniformsData {
     glm::mat4 view;         // 64 bytes
@@ -9,6 +10,19 @@ struct GlobalUniformsData {
     glm::vec4 viewPosTime;  // 16 bytes (xyz=pos, w=time)
 };
 
+// Per-frame pass parameters (std140, matches include/frame_params.glsl)
+struct FrameParamsData {
+    glm::vec2 renderSize;      // 8 bytes
+    float zNear;               // 4 bytes
+    float zFar;                // 4 bytes
+    float starBrightnessFade;  // 4 bytes
+    float gasPointScale;       // 4 bytes
+    float starFluxThreshold;   // 4 bytes (QualitySettings)
+    float gasLodArea;          // 4 bytes (QualitySettings)
+    float starLodBrightness;   // 4 bytes (QualitySettings)
+    float padding[3];          // Block size rounds up to 48 bytes
+};
+
 class GlobalUniformBuffer {
 public:
     unsigned int UBO;
@@ -39,8 +53,37 @@ public:
         data.projection = projection;
         data.viewPosTime = glm::vec4(camPos, time);
 
+        // Streamed through the frame ring; UBO is only written if there's no ring slice to use
+        bindFrameUniforms(BINDING_POINT, UBO, &data, sizeof(GlobalUniformsData));
+    }
+};
+
+// Shared by the cull, star and depth resolve passes, replacing per-pass uniforms set every frame
+class FrameParamsBuffer {
+public:
+    unsigned int UBO;
+    const unsigned int BINDING_POINT = 1;
+
+    FrameParamsBuffer() {
+        glGenBuffers(1, &UBO);
         glBindBuffer(GL_UNIFORM_BUFFER, UBO);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GlobalUniformsData), &data);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameParamsData), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, UBO);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
+
+    ~FrameParamsBuffer() {
+        if (UBO != 0) {
+            glDeleteBuffers(1, &UBO);
+            UBO = 0;
+        }
+    }
+
+    // Prevent copying
+    FrameParamsBuffer(const FrameParamsBuffer&) = delete;
+    FrameParamsBuffer& operator=(const FrameParamsBuffer&) = delete;
+
+    void update(const FrameParamsData& data) {
+        bindFrameUniforms(BINDING_POINT, UBO, &data, sizeof(FrameParamsData));
+    }
 };
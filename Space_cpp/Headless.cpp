@@ -0,0 +1,137 @@
+#include "Headless.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <algorithm>
+
+#ifdef GALAXY_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay g_eglDisplay = EGL_NO_DISPLAY;
+static EGLContext g_eglContext = EGL_NO_CONTEXT;
+
+bool initHeadlessContext() {
+    // 1. Surfaceless display (Mesa), falling back to the default display
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        g_eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (g_eglDisplay == EGL_NO_DISPLAY) {
+        g_eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (g_eglDisplay == EGL_NO_DISPLAY || !eglInitialize(g_eglDisplay, &major, &minor)) {
+        std::cerr << "Headless: Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+    std::cout << "Headless: EGL " << major << "." << minor << std::endl;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "Headless: EGL has no desktop OpenGL support" << std::endl;
+        cleanupHeadlessContext();
+        return false;
+    }
+
+    // 2. Core context without a config or surface (EGL_KHR_no_config_context + surfaceless).
+    // Prefer 4.6 like the windowed build; llvmpipe exposes 4.5, the minimum: the renderer uses
+    // direct state access, glClearTexImage and glBufferStorage (4.4/4.5).
+    const EGLint versions[][2] = { {4, 6}, {4, 5} };
+    for (const auto& version : versions) {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        g_eglContext = eglCreateContext(g_eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+        if (g_eglContext != EGL_NO_CONTEXT) break;
+    }
+
+    if (g_eglContext == EGL_NO_CONTEXT) {
+        std::cerr << "Headless: Failed to create an OpenGL 4.5+ core context (0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        cleanupHeadlessContext();
+        return false;
+    }
+
+    if (!eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, g_eglContext)) {
+        std::cerr << "Headless: Failed to make the surfaceless context current" << std::endl;
+        cleanupHeadlessContext();
+        return false;
+    }
+
+    // 3. Load GL
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        cleanupHeadlessContext();
+        return false;
+    }
+    // Functions above the context's version stay null in glad
+    if (!GLAD_GL_VERSION_4_5) {
+        std::cerr << "Headless: OpenGL 4.5 is required, the context is " << glGetString(GL_VERSION) << std::endl;
+        cleanupHeadlessContext();
+        return false;
+    }
+
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+    return true;
+}
+
+void cleanupHeadlessContext() {
+    if (g_eglDisplay == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (g_eglContext != EGL_NO_CONTEXT) {
+        eglDestroyContext(g_eglDisplay, g_eglContext);
+        g_eglContext = EGL_NO_CONTEXT;
+    }
+    eglTerminate(g_eglDisplay);
+    g_eglDisplay = EGL_NO_DISPLAY;
+}
+
+#else
+
+bool initHeadlessContext() {
+    std::cerr << "Headless: This build has no EGL support (build on Linux for --headless)" << std::endl;
+    return false;
+}
+
+void cleanupHeadlessContext() {
+}
+
+#endif
+
+void printFrameTimingStats(const std::vector<double>& frameTimesMs) {
+    if (frameTimesMs.empty()) return;
+
+    std::vector<double> sorted = frameTimesMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (double t : sorted) total += t;
+
+    auto percentile = [&sorted](double p) {
+        size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    };
+
+    std::cout << "Headless: " << sorted.size() << " frames in " << total << " ms" << std::endl;
+    std::cout << "  min " << sorted.front() << " ms"
+              << " | avg " << total / sorted.size() << " ms"
+              << " | p50 " << percentile(0.50) << " ms"
+              << " | p95 " << percentile(0.95) << " ms"
+              << " | max " << sorted.back() << " ms" << std::endl;
+}
+
+void printStateStats(const GLState::Counters& totals, int frameCount) {
+    if (frameCount <= 0) return;
+
+    auto perFrame = [frameCount](unsigned int total) { return (double)total / frameCount; };
+    std::cout << "  per frame: " << perFrame(totals.drawCalls) << " draws"
+              << " | " << perFrame(totals.dispatches) << " dispatches"
+              << " | " << perFrame(totals.programSwitches) << " program switches"
+              << " | " << perFrame(totals.framebufferBinds) << " FBO binds" << std::endl;
+    std::cout << "  state changes: " << perFrame(totals.stateChanges) << " issued"
+              << " | " << perFrame(totals.stateChangesFiltered) << " filtered" << std::endl;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "GLState.h"
+#include <vector>
+
+// Headless (windowless) rendering for batch and CI runs.
+// Renders the full pipeline into the PostProcessor's offscreen targets using a
+// surfaceless EGL context, so it also runs on GPU-less machines under Mesa llvmpipe.
+// Options (--headless, --frames, --timestep, ...) are parsed in Options.h.
+
+// Creates a surfaceless GL 4.5+ core context, makes it current and loads GL through glad.
+// Only available in builds with GALAXY_HEADLESS_EGL (Linux); returns false otherwise.
+bool initHeadlessContext();
+void cleanupHeadlessContext();
+
+// Prints min/avg/p50/p95/max of the per-frame times
+void printFrameTimingStats(const std::vector<double>& frameTimesMs);
+
+// Prints the per-frame averages of the GLState counters summed over frameCount frames
+void printStateStats(const GLState::Counters& totals, int frameCount);
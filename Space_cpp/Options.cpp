@@ -0,0 +1,98 @@
+#include "Options.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--headless] [--width <px>] [--height <px>]"
+              << " [--frames <n>] [--timestep <seconds>]"
+              << " [--capture <dir>] [--capture-raw <path|->] [--capture-y4m <path|->]"
+              << " [--shader-cache <dir> | --no-shader-cache]"
+              << " [--cull-compaction <auto|subgroup|workgroup>] [--frame-budget <ms>]"
+              << " [--render-scale <0.5-1>] [--cull-slices <n>]"
+              << " [--max-fps <n>] [--background-fps <n>] [--check-star-lod]"
+              << " [--check-render-scale]" << std::endl;
+}
+
+bool parseLaunchOptions(int argc, char** argv, LaunchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+        } else if (strcmp(arg, "--width") == 0 && hasValue) {
+            options.width = atoi(argv[++i]);
+        } else if (strcmp(arg, "--height") == 0 && hasValue) {
+            options.height = atoi(argv[++i]);
+        } else if (strcmp(arg, "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(arg, "--timestep") == 0 && hasValue) {
+            options.timestep = atof(argv[++i]);
+        } else if (strcmp(arg, "--capture") == 0 && hasValue) {
+            options.captureDir = argv[++i];
+        } else if (strcmp(arg, "--capture-raw") == 0 && hasValue) {
+            options.captureRawPath = argv[++i];
+        } else if (strcmp(arg, "--capture-y4m") == 0 && hasValue) {
+            options.captureY4MPath = argv[++i];
+        } else if (strcmp(arg, "--shader-cache") == 0 && hasValue) {
+            options.shaderCacheDir = argv[++i];
+        } else if (strcmp(arg, "--no-shader-cache") == 0) {
+            options.shaderCacheDir.clear();
+        } else if (strcmp(arg, "--cull-compaction") == 0 && hasValue) {
+            options.cullCompaction = argv[++i];
+        } else if (strcmp(arg, "--frame-budget") == 0 && hasValue) {
+            options.frameBudgetMs = atof(argv[++i]);
+            if (options.frameBudgetMs < 0.0) {
+                std::cerr << "--frame-budget must be 0 (off) or a time in milliseconds" << std::endl;
+                return false;
+            }
+        } else if (strcmp(arg, "--render-scale") == 0 && hasValue) {
+            options.renderScale = atof(argv[++i]);
+        } else if (strcmp(arg, "--cull-slices") == 0 && hasValue) {
+            options.cullSlices = atoi(argv[++i]);
+            if (options.cullSlices < 1) {
+                std::cerr << "--cull-slices must be at least 1" << std::endl;
+                return false;
+            }
+        } else if (strcmp(arg, "--max-fps") == 0 && hasValue) {
+            options.maxFps = atof(argv[++i]);
+        } else if (strcmp(arg, "--background-fps") == 0 && hasValue) {
+            options.backgroundFps = atof(argv[++i]);
+        } else if (strcmp(arg, "--check-star-lod") == 0) {
+            options.checkStarLod = true;
+            options.headless = true;
+        } else if (strcmp(arg, "--check-render-scale") == 0) {
+            options.checkRenderScale = true;
+            options.headless = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0 || options.timestep < 0.0) {
+        std::cerr << "Invalid size, frame count or timestep" << std::endl;
+        printUsage(argv[0]);
+        return false;
+    }
+    if (options.cullCompaction != "auto" && options.cullCompaction != "subgroup" && options.cullCompaction != "workgroup") {
+        std::cerr << "--cull-compaction must be auto, subgroup or workgroup" << std::endl;
+        return false;
+    }
+    if (options.maxFps < 0.0 || options.backgroundFps < 0.0) {
+        std::cerr << "--max-fps and --background-fps must be 0 (uncapped) or a frame rate" << std::endl;
+        return false;
+    }
+    if (options.renderScale != 0.0 && (options.renderScale < 0.5 || options.renderScale > 1.0)) {
+        std::cerr << "--render-scale must be between 0.5 and 1" << std::endl;
+        return false;
+    }
+    int captureModes = !options.captureDir.empty() + !options.captureRawPath.empty() + !options.captureY4MPath.empty();
+    if (captureModes > 1) {
+        std::cerr << "--capture, --capture-raw and --capture-y4m are mutually exclusive" << std::endl;
+        return false;
+    }
+    return true;
+}
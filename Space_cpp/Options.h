@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+
+// Command-line options
+struct LaunchOptions {
+    // Headless rendering (see Headless.h); width/height also set the initial window size
+    bool headless = false;
+    int width = 1280;
+    int height = 720;
+    int frames = 300;
+    double timestep = 1.0 / 60.0; // Fixed simulation step per frame (seconds)
+
+    // Frame capture (see FrameCapture.h)
+    std::string captureDir;     // PNG sequence directory
+    std::string captureRawPath; // Raw RGB24 frames to a file or named pipe ("-" = stdout)
+    std::string captureY4MPath; // Y4M (4:2:0) stream to a file or named pipe ("-" = stdout)
+    bool isCapturing() const { return !captureDir.empty() || !captureRawPath.empty() || !captureY4MPath.empty(); }
+
+    // Linked program binaries (see ProgramCache.h); empty disables the cache
+    std::string shaderCacheDir = "shader_cache";
+
+    // Cull shader compaction variant (see SpriteArena.h): "auto", "subgroup" or "workgroup"
+    std::string cullCompaction = "auto";
+
+    // Scene GPU time budget for the quality governor (see QualityGovernor.h); 0 holds the
+    // default quality. Negative: 60 fps in a window, off for headless runs and captures
+    // (reproducible output)
+    double frameBudgetMs = -1.0;
+
+    // Internal resolution as a fraction of the output (0.5 - 1, spatially upscaled);
+    // 0 leaves it to the quality level
+    double renderScale = 0.0;
+    double resolveFrameBudget() const {
+        if (frameBudgetMs >= 0.0) return frameBudgetMs;
+        return (headless || isCapturing()) ? 0.0 : 1000.0 / 60.0;
+    }
+
+    // Temporal slices of the star and gas culls (see CullSlicer.h, at most MAX_SLICES);
+    // 1 culls everything every frame
+    int cullSlices = 1;
+
+    // Frame rate caps of a window (see FramePacer.h) while focused and in the background;
+    // 0 is uncapped. Captures are never capped
+    double maxFps = 0.0;
+    double backgroundFps = 10.0;
+
+    // Headless self-check of the stochastic star LOD instead of rendering frames; the exit
+    // code reports the result (registered with ctest)
+    bool checkStarLod = false;
+    // Headless diagnostic comparing the image borders after the render scale steps down with a
+    // reference rendered into zeroed targets; the exit code reports the result (not in ctest)
+    bool checkRenderScale = false;
+};
+
+// Parses --headless, --width <px>, --height <px>, --frames <n>, --timestep <seconds>,
+// --capture <dir>, --capture-raw <path>, --capture-y4m <path>, --shader-cache <dir>, --no-shader-cache,
+// --cull-compaction <auto|subgroup|workgroup>, --frame-budget <ms>, --render-scale <0.5-1>,
+// --cull-slices <n>, --max-fps <n>, --background-fps <n>, --check-star-lod,
+// --check-render-scale (both imply --headless).
+// Returns false (after printing usage) on unknown or malformed arguments.
+bool parseLaunchOptions(int argc, char** argv, LaunchOptions& options);
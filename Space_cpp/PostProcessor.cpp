@@ -1,35 +1,89 @@
 #include "PostProcessor.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
 #include <iostream>
+#include <algorithm>
+
+// Rounds a dimension up to the next quarter-octave step (..., 1024, 1280, 1536, 1792, 2048, 2560, ...)
+// so a window drag only reallocates the render targets a handful of times.
+static unsigned int RoundUpCapacity(unsigned int size) {
+    unsigned int step = 64;
+    while (step * 8 <= size) step *= 2;
+    return ((size + step - 1) / step) * step;
+}
 
-PostProcessor::PostProcessor(unsigned int width, unsigned int height)
-    : Width(width), Height(height) {
+PostProcessor::PostProcessor(unsigned int width, unsigned int height, float renderScale)
+    : OutputWidth(width), OutputHeight(height),
+      RenderScale(std::clamp(renderScale, MIN_RENDER_SCALE, MAX_RENDER_SCALE)) {
     std::cout << "PostProcessor: Constructor" << std::endl;
 
+    // Targets are allocated for the scaled size: a fixed render scale saves their memory too
+    glm::uvec2 renderSize = GetScaledSize(width, height);
+    Width = renderSize.x;
+    Height = renderSize.y;
+    CapacityWidth = RoundUpCapacity(Width);
+    CapacityHeight = RoundUpCapacity(Height);
+
     // Load shaders
     std::cout << "PostProcessor: Loading Shaders..." << std::endl;
+    ShaderLibrary::BeginBatch();
     postShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/post.frag");
     downsampleShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/downsample.frag");
     upsampleShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/upsample.frag");
     gasCompositeShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/bilateral_composite.frag");
-    depthDownsampleShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/depth_downsample.frag");
+    depthResolveShader = std::make_unique<Shader>("assets/shaders/depth_resolve.comp");
+    depthResolveSingleSampleShader = std::make_unique<Shader>("assets/shaders/depth_resolve.comp", std::vector<std::string>{ "SINGLE_SAMPLE" });
+    easuShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/easu.frag");
+    rcasShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/rcas.frag");
+    ShaderLibrary::EndBatch();
 
+    // Constant uniforms are set once; the render size and clip planes come from FrameParams
     postShader->use();
     postShader->setInt("scene", 0);
     postShader->setInt("bloomBlur", 1);
+    postShader->setInt("bloom", true);
+    postShader->setFloat("exposure", 0.015f); // Exposure level
+    PostUVScale = postShader->GetUniform<glm::vec2>("uvScale");
+    PostBloomMaxUV = postShader->GetUniform<glm::vec2>("bloomMaxUV");
 
     downsampleShader->use();
     downsampleShader->setInt("srcTexture", 0);
+    DownsampleSrcResolution = downsampleShader->GetUniform<glm::vec2>("srcResolution");
+    DownsampleUVScale = downsampleShader->GetUniform<glm::vec2>("uvScale");
+    DownsampleMaxUV = downsampleShader->GetUniform<glm::vec2>("maxUV");
 
     upsampleShader->use();
     upsampleShader->setInt("srcTexture", 0);
+    upsampleShader->setFloat("filterRadius", 0.005f);
+    UpsampleUVScale = upsampleShader->GetUniform<glm::vec2>("uvScale");
+    UpsampleMaxUV = upsampleShader->GetUniform<glm::vec2>("maxUV");
 
     gasCompositeShader->use();
     gasCompositeShader->setInt("gasTexture", 0);
     gasCompositeShader->setInt("quarterResLinearDepth", 1);
     gasCompositeShader->setInt("highResDepth", 2);
+    gasCompositeShader->setFloat("depthSensitivity", 0.1f);
+    GasCompositeLowResScale = gasCompositeShader->GetUniform<float>("lowResScale");
+
+    depthResolveShader->use();
+    depthResolveShader->setInt("depthMap", 0);
+    depthResolveShader->setInt("sampleCount", 4);
+    DepthResolveLowResSize = depthResolveShader->GetUniform<glm::ivec2>("lowResSize");
+    DepthResolveLowResFactor = depthResolveShader->GetUniform<int>("lowResFactor");
+
+    depthResolveSingleSampleShader->use();
+    depthResolveSingleSampleShader->setInt("depthMap", 0);
+    DepthResolveSingleSampleLowResSize = depthResolveSingleSampleShader->GetUniform<glm::ivec2>("lowResSize");
+    DepthResolveSingleSampleLowResFactor = depthResolveSingleSampleShader->GetUniform<int>("lowResFactor");
 
-    depthDownsampleShader->use();
-    depthDownsampleShader->setInt("depthMap", 0);
+    easuShader->use();
+    easuShader->setInt("source", 0);
+    EasuSourceSize = easuShader->GetUniform<glm::vec2>("sourceSize");
+    EasuOutputSize = easuShader->GetUniform<glm::vec2>("outputSize");
+
+    rcasShader->use();
+    rcasShader->setInt("source", 0);
+    rcasShader->setFloat("sharpness", RCAS_SHARPNESS);
 
     std::cout << "PostProcessor: InitFramebuffers..." << std::endl;
     InitFramebuffers();
@@ -39,16 +93,16 @@ PostProcessor::PostProcessor(unsigned int width, unsigned int height)
 }
 
 PostProcessor::~PostProcessor() {
-    glDeleteFramebuffers(1, &MSAAFBO);
-    glDeleteTextures(1, &MSAATexture);
-    glDeleteTextures(1, &MSAADepthTexture);
+    ReleaseFramebuffers();
+    ReleaseOutputTarget();
+    ReleaseUpscaledTarget();
+    glDeleteVertexArrays(1, &QuadVAO);
+}
 
-    glDeleteFramebuffers(1, &DepthCopyFBO);
-    glDeleteTextures(1, &MSAADepthCopyTexture);
-    glDeleteTextures(1, &MSAADummyColorTexture);
+void PostProcessor::ReleaseFramebuffers() {
+    ReleaseMSAATargets();
 
     glDeleteFramebuffers(1, &LowResGasFBO);
-    glDeleteFramebuffers(1, &LowResDepthFBO);
     glDeleteTextures(1, &LowResGasTexture);
     glDeleteTextures(1, &LowResDepthTexture);
 
@@ -56,19 +110,19 @@ PostProcessor::~PostProcessor() {
     glDeleteTextures(1, &ScreenTexture);
     glDeleteTextures(1, &DepthTexture);
 
-    glDeleteFramebuffers(1, &ResolvedDepthCopyFBO);
-    glDeleteTextures(1, &ResolvedDepthCopyTexture);
+    glDeleteTextures(1, &LinearDepthTexture);
+
+    glDeleteFramebuffers(1, &UpscaleSourceFBO);
+    glDeleteTextures(1, &UpscaleSourceTexture);
 
     glDeleteFramebuffers(1, &MipChainFBO);
     for (auto& mip : mipChain) {
         glDeleteTextures(1, &mip.texture);
     }
     mipChain.clear();
-
-    glDeleteVertexArrays(1, &QuadVAO);
 }
 
-void PostProcessor::InitFramebuffers() {
+void PostProcessor::InitMSAATargets() {
     std::cout << "PostProcessor: Generating MSAA FBO..." << std::endl;
     // 1. Multisampled FBO
     glGenFramebuffers(1, &MSAAFBO);
@@ -76,13 +130,13 @@ void PostProcessor::InitFramebuffers() {
 
     glGenTextures(1, &MSAATexture);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, MSAATexture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA16F, Width, Height, GL_TRUE); // HDR & MSAA
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA16F, CapacityWidth, CapacityHeight, GL_TRUE); // HDR & MSAA
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, MSAATexture, 0);
 
     glGenTextures(1, &MSAADepthTexture);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, MSAADepthTexture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_DEPTH_COMPONENT24, Width, Height, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_DEPTH_COMPONENT24, CapacityWidth, CapacityHeight, GL_TRUE);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D_MULTISAMPLE, MSAADepthTexture, 0);
 
@@ -90,27 +144,116 @@ void PostProcessor::InitFramebuffers() {
         std::cout << "ERROR::POSTPROCESSOR: MSAA Framebuffer not complete!" << std::endl;
 
     std::cout << "PostProcessor: Generating Depth Copy FBO..." << std::endl;
-    // 1b. Depth Copy FBO (MSAA) to break feedback loop
+    // 2. Depth Copy FBO (MSAA) to break feedback loop
     glGenFramebuffers(1, &DepthCopyFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, DepthCopyFBO);
 
     glGenTextures(1, &MSAADepthCopyTexture);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, MSAADepthCopyTexture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_DEPTH_COMPONENT24, Width, Height, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_DEPTH_COMPONENT24, CapacityWidth, CapacityHeight, GL_TRUE);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D_MULTISAMPLE, MSAADepthCopyTexture, 0);
 
     // Dummy Color Texture to make FBO "Complete" on picky drivers
     glGenTextures(1, &MSAADummyColorTexture);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, MSAADummyColorTexture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_R8, Width, Height, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_R8, CapacityWidth, CapacityHeight, GL_TRUE);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, MSAADummyColorTexture, 0);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Depth Copy Framebuffer not complete!" << std::endl;
 
-    // 1c. Low-Resolution Gas Rendering (Quarter Resolution)
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::ReleaseMSAATargets() {
+    if (MSAAFBO == 0) return;
+    glDeleteFramebuffers(1, &MSAAFBO);
+    glDeleteTextures(1, &MSAATexture);
+    glDeleteTextures(1, &MSAADepthTexture);
+
+    glDeleteFramebuffers(1, &DepthCopyFBO);
+    glDeleteTextures(1, &MSAADepthCopyTexture);
+    glDeleteTextures(1, &MSAADummyColorTexture);
+
+    MSAAFBO = MSAATexture = MSAADepthTexture = 0;
+    DepthCopyFBO = MSAADepthCopyTexture = MSAADummyColorTexture = 0;
+}
+
+void PostProcessor::EnableOffscreenOutput(bool present) {
+    PresentToScreen = present;
+    if (OutputFBO != 0) return;
+    InitOutputTarget();
+}
+
+void PostProcessor::PresentOutput() {
+    if (OutputFBO == 0 || !PresentToScreen) return;
+
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, OutputFBO);
+    GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, OutputWidth, OutputHeight, 0, 0, OutputWidth, OutputHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::InitOutputTarget() {
+    OutputTargetWidth = OutputWidth;
+    OutputTargetHeight = OutputHeight;
+
+    glGenFramebuffers(1, &OutputFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, OutputFBO);
+
+    glGenTextures(1, &OutputTexture);
+    glBindTexture(GL_TEXTURE_2D, OutputTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, OutputWidth, OutputHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, OutputTexture, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR: Output Framebuffer not complete!" << std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::ReleaseOutputTarget() {
+    if (OutputFBO == 0) return;
+    glDeleteFramebuffers(1, &OutputFBO);
+    glDeleteTextures(1, &OutputTexture);
+    OutputFBO = 0;
+    OutputTexture = 0;
+}
+
+void PostProcessor::InitUpscaledTarget() {
+    UpscaledTargetWidth = OutputWidth;
+    UpscaledTargetHeight = OutputHeight;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &UpscaledTexture);
+    glTextureStorage2D(UpscaledTexture, 1, GL_RGBA8, OutputWidth, OutputHeight);
+    glTextureParameteri(UpscaledTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(UpscaledTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glCreateFramebuffers(1, &UpscaledFBO);
+    glNamedFramebufferTexture(UpscaledFBO, GL_COLOR_ATTACHMENT0, UpscaledTexture, 0);
+
+    if (glCheckNamedFramebufferStatus(UpscaledFBO, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR: Upscaled Framebuffer not complete!" << std::endl;
+}
+
+void PostProcessor::ReleaseUpscaledTarget() {
+    if (UpscaledFBO == 0) return;
+    glDeleteFramebuffers(1, &UpscaledFBO);
+    glDeleteTextures(1, &UpscaledTexture);
+    UpscaledFBO = 0;
+    UpscaledTexture = 0;
+}
+
+void PostProcessor::InitFramebuffers() {
+    LinearDepthCleared = false;
+    SceneRendered = false;
+
+    // The MSAA targets are allocated by BeginRender on first use (InitMSAATargets)
+    // 1. Low-Resolution Gas Rendering (allocated at half resolution, used at 1/2, 1/4 or 1/8)
     // FBO 1: Gas Accumulation (Color Only)
     std::cout << "PostProcessor: Generating Low-Res Gas FBO..." << std::endl;
     glGenFramebuffers(1, &LowResGasFBO);
@@ -121,7 +264,7 @@ void PostProcessor::InitFramebuffers() {
     // Optimization: Use R11G11B10F to reduce memory bandwidth by 50% (32 bits vs 64 bits)
     // We are accumulating additive light, so we don't need the alpha channel in the buffer.
     // Optimization 2: Use Quarter-Resolution (Width/4) to massively reduce fill-rate cost.
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, (unsigned int)(Width * LOW_RES_SCALE), (unsigned int)(Height * LOW_RES_SCALE), 0, GL_RGB, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, CapacityWidth / MIN_LOW_RES_FACTOR, CapacityHeight / MIN_LOW_RES_FACTOR, 0, GL_RGB, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -131,25 +274,15 @@ void PostProcessor::InitFramebuffers() {
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Low-Res Gas FBO not complete!" << std::endl;
 
-    // FBO 2: Depth Downsampling (R32F, Linear Depth Only)
-    std::cout << "PostProcessor: Generating Low-Res Depth FBO..." << std::endl;
-    glGenFramebuffers(1, &LowResDepthFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, LowResDepthFBO);
-
+    // Low-Res Min/Max Linear Depth (RG32F, image written by the depth resolve)
     glGenTextures(1, &LowResDepthTexture);
     glBindTexture(GL_TEXTURE_2D, LowResDepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, (unsigned int)(Width * LOW_RES_SCALE), (unsigned int)(Height * LOW_RES_SCALE), 0, GL_RED, GL_FLOAT, NULL);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG32F, CapacityWidth / MIN_LOW_RES_FACTOR, CapacityHeight / MIN_LOW_RES_FACTOR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    // Attach to COLOR_ATTACHMENT0 (not 1)
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, LowResDepthTexture, 0);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Low-Res Depth FBO not complete!" << std::endl;
-
     std::cout << "PostProcessor: Generating Intermediate FBO..." << std::endl;
     // 2. Intermediate FBO (for resolving MSAA and HDR bloom extraction)
     glGenFramebuffers(1, &IntermediateFBO);
@@ -157,7 +290,7 @@ void PostProcessor::InitFramebuffers() {
 
     glGenTextures(1, &ScreenTexture);
     glBindTexture(GL_TEXTURE_2D, ScreenTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, Width, Height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, CapacityWidth, CapacityHeight, 0, GL_RGBA, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -166,7 +299,7 @@ void PostProcessor::InitFramebuffers() {
 
     glGenTextures(1, &DepthTexture);
     glBindTexture(GL_TEXTURE_2D, DepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, Width, Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, CapacityWidth, CapacityHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -176,24 +309,28 @@ void PostProcessor::InitFramebuffers() {
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Intermediate Framebuffer not complete!" << std::endl;
 
-    // 2b. Resolved Depth Copy FBO (for reading depth while testing against Intermediate)
-    glGenFramebuffers(1, &ResolvedDepthCopyFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, ResolvedDepthCopyFBO);
-
-    glGenTextures(1, &ResolvedDepthCopyTexture);
-    glBindTexture(GL_TEXTURE_2D, ResolvedDepthCopyTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, Width, Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // 2b. Full-Res Linear Depth (for reading depth while testing against Intermediate)
+    glGenTextures(1, &LinearDepthTexture);
+    glBindTexture(GL_TEXTURE_2D, LinearDepthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, CapacityWidth, CapacityHeight);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, ResolvedDepthCopyTexture, 0);
-    // No color attachment
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
+
+    // 2c. Tonemapped composite at the render size, the source of the spatial upscale (LDR, read with texelFetch)
+    glGenFramebuffers(1, &UpscaleSourceFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, UpscaleSourceFBO);
+
+    glGenTextures(1, &UpscaleSourceTexture);
+    glBindTexture(GL_TEXTURE_2D, UpscaleSourceTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, CapacityWidth, CapacityHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, UpscaleSourceTexture, 0);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Resolved Depth Copy Framebuffer not complete!" << std::endl;
+        std::cout << "ERROR::POSTPROCESSOR: Upscale Source Framebuffer not complete!" << std::endl;
 
     InitBloomMips();
 }
@@ -202,11 +339,11 @@ void PostProcessor::InitBloomMips() {
     glGenFramebuffers(1, &MipChainFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, MipChainFBO);
 
-    glm::vec2 mipSize((float)Width, (float)Height); // Start from Full Res
+    glm::vec2 mipSize((float)CapacityWidth, (float)CapacityHeight); // Start from Full Res (allocated size)
     glm::ivec2 mipIntSize = (glm::ivec2)mipSize;
 
     // Generate 6 mips (1/2, 1/4, 1/8, 1/16, 1/32, 1/64)
-    for (int i = 0; i < 6; i++) {
+    for (int i = 0; i < MAX_BLOOM_MIPS; i++) {
         BloomMip mip;
         mipSize *= 0.5f;
         mipIntSize /= 2;
@@ -238,137 +375,249 @@ void PostProcessor::InitRenderData() {
     glBindVertexArray(0);
 }
 
-void PostProcessor::BeginRender() {
-    glBindFramebuffer(GL_FRAMEBUFFER, MSAAFBO);
+void PostProcessor::SetQuality(bool msaa, int lowResFactor, int bloomMips) {
+    MSAAEnabled = msaa;
+    // The depth resolve's blocks must tile its 16x16 workgroups
+    LowResFactor = std::clamp(lowResFactor, MIN_LOW_RES_FACTOR, 8);
+    BloomMipCount = std::clamp(bloomMips, 1, MAX_BLOOM_MIPS);
+}
+
+void PostProcessor::BeginRender(bool renderOpaque) {
+    OpaquePassActive = renderOpaque;
+    OpaquePassMSAA = renderOpaque && MSAAEnabled;
+    SceneRendered = false; // Overwritten from here until EndRender
+
+    // The MSAA targets are the largest ones: they only exist while the quality level uses
+    // them, so stepping down frees their memory. Allocated at the current capacity on first use
+    if (OpaquePassMSAA && MSAAFBO == 0) {
+        InitMSAATargets();
+        // Creating objects with raw GL binds them behind the tracker's back
+        GLState::Reset();
+    } else if (!MSAAEnabled && MSAAFBO != 0) {
+        std::cout << "PostProcessor: Releasing MSAA targets" << std::endl;
+        ReleaseMSAATargets();
+        GLState::Reset();
+    }
+
+    // Without opaque geometry the MSAA target would only be cleared and resolved; without
+    // MSAA the opaque pass renders straight into the Intermediate FBO and needs no blit
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, OpaquePassMSAA ? MSAAFBO : IntermediateFBO);
     glViewport(0, 0, Width, Height);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    GLState::DepthMask(GL_TRUE); // The depth clear obeys the write mask
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
+    GLState::Enable(GL_DEPTH_TEST);
 }
 
 void PostProcessor::PerformOpaqueResolve() {
+    if (!OpaquePassActive) {
+        // Depth is uniformly at the far plane: fill the linear depth textures once and keep
+        // them until opaque geometry shows up again (or the targets are recreated)
+        if (!LinearDepthCleared) {
+            const float farDepth[2] = { 20000.0f, 20000.0f }; // LinearizeDepth(1.0) == zFar
+            glClearTexImage(LinearDepthTexture, 0, GL_RED, GL_FLOAT, farDepth);
+            glClearTexImage(LowResDepthTexture, 0, GL_RG, GL_FLOAT, farDepth);
+            LinearDepthCleared = true;
+        }
+
+        // Already rendering into the Intermediate FBO
+        glViewport(0, 0, Width, Height);
+        return;
+    }
+    LinearDepthCleared = false;
+
     // 1. Resolve MSAA Color -> Intermediate ScreenTexture (Implicitly)
     // 2. Resolve MSAA Depth -> Intermediate DepthTexture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, MSAAFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, IntermediateFBO);
-    glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    // (Single-sample opaque pass: already rendered there)
+    if (OpaquePassMSAA) {
+        GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, MSAAFBO);
+        GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, IntermediateFBO);
+        glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
 
-    // 3. Copy Resolved Depth -> ResolvedDepthCopyTexture (for sampling)
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, IntermediateFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ResolvedDepthCopyFBO);
-    glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    // 3. Fused Depth Resolve (Compute)
+    // Reads the opaque depth once and writes full-res linear depth (soft particles, occlusion
+    // culling, bilateral upsample) and low-res min/max linear depth (low-res gas pass).
+    // The hardware depth for testing still comes from the blit above: depth formats can't be image stores.
+    // Without MSAA it reads DepthTexture, attached to the bound Intermediate FBO but not drawn to meanwhile.
+    if (OpaquePassMSAA) {
+        depthResolveShader->use();
+        DepthResolveLowResSize.Set(GetLowResRenderSize());
+        DepthResolveLowResFactor.Set(LowResFactor);
+        GLState::BindTexture(0, MSAADepthTexture);
+    } else {
+        depthResolveSingleSampleShader->use();
+        DepthResolveSingleSampleLowResSize.Set(GetLowResRenderSize());
+        DepthResolveSingleSampleLowResFactor.Set(LowResFactor);
+        GLState::BindTexture(0, DepthTexture);
+    }
+    glBindImageTexture(0, LinearDepthTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glBindImageTexture(1, LowResDepthTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+
+    glDispatchCompute((Width + 15) / 16, (Height + 15) / 16, 1);
+    GLState::CountDispatch();
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    GLState::BindTexture(0, 0);
 
     // 4. Bind Intermediate FBO for Transparent Rendering
-    glBindFramebuffer(GL_FRAMEBUFFER, IntermediateFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, IntermediateFBO);
     glViewport(0, 0, Width, Height);
     // Depth Test Enabled, Depth Mask False usually (set by renderer)
 }
 
 void PostProcessor::EndRender() {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_SCISSOR_TEST); // Ensure we draw to the full FBO
+    GLState::Disable(GL_DEPTH_TEST);
+    GLState::Disable(GL_BLEND);
+    GLState::Disable(GL_CULL_FACE);
+    GLState::Disable(GL_SCISSOR_TEST); // Ensure we draw to the full FBO
 
+    glm::vec2 sceneUVScale = GetRenderUVScale();
 
     // 2. Dual-Filter Bloom Pass
-    glBindFramebuffer(GL_FRAMEBUFFER, MipChainFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, MipChainFBO);
+    GLState::BindVertexArray(QuadVAO);
 
     // DOWNSAMPLE PHASE
     downsampleShader->use();
-    downsampleShader->setInt("srcTexture", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ScreenTexture); // Source for Mip 0
+    GLState::BindTexture(0, ScreenTexture); // Source for Mip 0
 
-    for (size_t i = 0; i < mipChain.size(); i++) {
+    size_t mipCount = GetActiveMipCount();
+    for (size_t i = 0; i < mipCount; i++) {
         const BloomMip& mip = mipChain[i];
+        glm::ivec2 mipRenderSize = GetMipRenderSize(i);
 
-        // Set viewport to target mip size
-        glViewport(0, 0, mip.size.x, mip.size.y);
+        // Set viewport to the active region of the target mip
+        glViewport(0, 0, mipRenderSize.x, mipRenderSize.y);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mip.texture, 0);
 
-        // Resolution of source texture
+        // Resolution of source texture (allocated size, for texel offsets) and the active region within it
         if (i == 0) {
-            downsampleShader->setVec2("srcResolution", (float)Width, (float)Height);
+            DownsampleSrcResolution.Set(glm::vec2(CapacityWidth, CapacityHeight));
+            DownsampleUVScale.Set(sceneUVScale);
+            DownsampleMaxUV.Set(GetActiveMaxUV(glm::ivec2(Width, Height), glm::ivec2(CapacityWidth, CapacityHeight)));
         } else {
-            downsampleShader->setVec2("srcResolution", (float)mipChain[i-1].size.x, (float)mipChain[i-1].size.y);
+            const BloomMip& srcMip = mipChain[i-1];
+            glm::ivec2 srcRenderSize = GetMipRenderSize(i-1);
+            DownsampleSrcResolution.Set(glm::vec2(srcMip.size));
+            DownsampleUVScale.Set(glm::vec2(srcRenderSize) / glm::vec2(srcMip.size));
+            DownsampleMaxUV.Set(GetActiveMaxUV(srcRenderSize, srcMip.size));
         }
 
-        glBindVertexArray(QuadVAO);
         glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::CountDraw();
 
         // Prepare for next iteration: Current mip becomes source
-        glBindTexture(GL_TEXTURE_2D, mip.texture);
+        GLState::BindTexture(0, mip.texture);
     }
 
     // UPSAMPLE PHASE
     upsampleShader->use();
-    upsampleShader->setInt("srcTexture", 0);
-    upsampleShader->setFloat("filterRadius", 0.005f);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE); // Additive Blending to accumulate bloom
+    GLState::Enable(GL_BLEND);
+    GLState::BlendFunc(GL_ONE, GL_ONE); // Additive Blending to accumulate bloom
 
-    for (int i = (int)mipChain.size() - 1; i > 0; i--) {
+    for (int i = (int)mipCount - 1; i > 0; i--) {
         const BloomMip& mip = mipChain[i];
         const BloomMip& nextMip = mipChain[i-1];
+        glm::ivec2 srcRenderSize = GetMipRenderSize(i);
+        glm::ivec2 dstRenderSize = GetMipRenderSize(i-1);
 
         // Source: Current small mip
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, mip.texture);
+        GLState::BindTexture(0, mip.texture);
+        UpsampleUVScale.Set(glm::vec2(srcRenderSize) / glm::vec2(mip.size));
+        UpsampleMaxUV.Set(GetActiveMaxUV(srcRenderSize, mip.size));
 
         // Target: Next larger mip
-        glViewport(0, 0, nextMip.size.x, nextMip.size.y);
+        glViewport(0, 0, dstRenderSize.x, dstRenderSize.y);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, nextMip.texture, 0);
 
-        glBindVertexArray(QuadVAO);
         glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::CountDraw();
     }
 
-    glDisable(GL_BLEND);
+    GLState::Disable(GL_BLEND);
+    SceneRendered = true;
 
-    // 3. Render to Screen (Composite)
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, Width, Height); // Restore Full Viewport
+    Composite();
+}
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    postShader->use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ScreenTexture);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, mipChain[0].texture); // Result of bloom is in Mip 0
-    postShader->setInt("bloom", true);
-    postShader->setFloat("exposure", 0.015f); // Exposure level
+void PostProcessor::Composite() {
+    GLState::Disable(GL_DEPTH_TEST);
+    GLState::Disable(GL_BLEND);
+    GLState::Disable(GL_CULL_FACE);
+    GLState::Disable(GL_SCISSOR_TEST);
 
-    glBindVertexArray(QuadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-}
+    glm::vec2 sceneUVScale = GetRenderUVScale();
 
-void PostProcessor::PrepareGasPass() {
-    // Bind the separate Depth FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, LowResDepthFBO);
-    glViewport(0, 0, (unsigned int)(Width * LOW_RES_SCALE), (unsigned int)(Height * LOW_RES_SCALE));
+    // 3. Render to Screen (Composite)
+    // The render size is smaller than the output with a render scale below 1, and while a
+    // debounced resize is pending: tonemap at the render size, then upscale and sharpen.
+    bool upscale = Width != OutputWidth || Height != OutputHeight;
+    if (OutputFBO != 0 && (OutputTargetWidth != OutputWidth || OutputTargetHeight != OutputHeight)) {
+        // Offscreen output follows the output size
+        ReleaseOutputTarget();
+        InitOutputTarget();
+        // Deleting bound objects unbinds them behind the tracker's back
+        GLState::Reset();
+    }
+    if (upscale && (UpscaledTargetWidth != OutputWidth || UpscaledTargetHeight != OutputHeight)) {
+        ReleaseUpscaledTarget();
+        InitUpscaledTarget();
+        GLState::Reset();
+    }
 
-    // Target: LowResDepthTexture is at Attachment 0
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    if (upscale) {
+        GLState::BindFramebuffer(GL_FRAMEBUFFER, UpscaleSourceFBO);
+        glViewport(0, 0, Width, Height);
+    } else {
+        GLState::BindFramebuffer(GL_FRAMEBUFFER, OutputFBO);
+        glViewport(0, 0, OutputWidth, OutputHeight); // Restore Full Viewport
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
-    depthDownsampleShader->use();
-    depthDownsampleShader->setFloat("zNear", 0.1f);
-    depthDownsampleShader->setFloat("zFar", 20000.0f);
-    depthDownsampleShader->setFloat("downsampleScale", 1.0f / LOW_RES_SCALE);
+    postShader->use();
+    PostUVScale.Set(sceneUVScale);
+    PostBloomMaxUV.Set(GetActiveMaxUV(GetMipRenderSize(0), mipChain[0].size));
+    GLState::BindTexture(0, ScreenTexture);
+    GLState::BindTexture(1, mipChain[0].texture); // Result of bloom is in Mip 0
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ResolvedDepthCopyTexture); // Use Resolved Single-Sample Depth
+    GLState::BindVertexArray(QuadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::CountDraw();
+    if (!upscale) return;
+
+    // 4. Edge-adaptive upscale to the output size (EASU)
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, UpscaledFBO);
+    glViewport(0, 0, OutputWidth, OutputHeight);
+    easuShader->use();
+    EasuSourceSize.Set(glm::vec2(Width, Height));
+    EasuOutputSize.Set(glm::vec2(OutputWidth, OutputHeight));
+    GLState::BindTexture(0, UpscaleSourceTexture);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::CountDraw();
 
-    // Full screen quad to downsample
-    glBindVertexArray(QuadVAO);
+    // 5. Sharpen into the output (RCAS)
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, OutputFBO);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    rcasShader->use();
+    GLState::BindTexture(0, UpscaledTexture);
     glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::CountDraw();
+}
+
+void PostProcessor::ClearSceneTargets() {
+    glClearTexImage(ScreenTexture, 0, GL_RGBA, GL_FLOAT, nullptr);
+    for (const BloomMip& mip : mipChain) {
+        glClearTexImage(mip.texture, 0, GL_RGB, GL_FLOAT, nullptr);
+    }
+    SceneRendered = false;
 }
 
 void PostProcessor::BeginGasPass() {
     // Bind the separate Gas FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, LowResGasFBO);
-    glViewport(0, 0, (unsigned int)(Width * LOW_RES_SCALE), (unsigned int)(Height * LOW_RES_SCALE));
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, LowResGasFBO);
+    glm::ivec2 lowResSize = GetLowResRenderSize();
+    glViewport(0, 0, lowResSize.x, lowResSize.y);
 
     // Target: Gas Color Texture (Attachment 0)
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
@@ -380,75 +629,120 @@ void PostProcessor::BeginGasPass() {
 
 void PostProcessor::EndGasPass() {
     // Composite Gas back to Intermediate FBO (Single Sample)
-    glBindFramebuffer(GL_FRAMEBUFFER, IntermediateFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, IntermediateFBO);
     glViewport(0, 0, Width, Height);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE); // Pure additive blending
-    glDisable(GL_DEPTH_TEST);
+    GLState::Enable(GL_BLEND);
+    GLState::BlendFunc(GL_ONE, GL_ONE); // Pure additive blending
+    GLState::Disable(GL_DEPTH_TEST);
 
     gasCompositeShader->use();
-    gasCompositeShader->setFloat("zNear", 0.1f);
-    gasCompositeShader->setFloat("zFar", 20000.0f);
-    gasCompositeShader->setFloat("depthSensitivity", 0.1f);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, LowResGasTexture);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, LowResDepthTexture);
+    GasCompositeLowResScale.Set(1.0f / LowResFactor);
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, ResolvedDepthCopyTexture); // Use Resolved Single-Sample Depth
+    GLState::BindTexture(0, LowResGasTexture);
+    GLState::BindTexture(1, LowResDepthTexture);
+    GLState::BindTexture(2, LinearDepthTexture);
 
-    glBindVertexArray(QuadVAO);
+    GLState::BindVertexArray(QuadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::CountDraw();
+}
 
-    // Restore state
-    glEnable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void PostProcessor::SetRenderScale(float scale) {
+    scale = std::clamp(scale, MIN_RENDER_SCALE, MAX_RENDER_SCALE);
+    if (scale == RenderScale) return;
+    RenderScale = scale;
+    Resize(OutputWidth, OutputHeight);
+}
+
+glm::uvec2 PostProcessor::GetScaledSize(unsigned int width, unsigned int height) const {
+    return glm::uvec2(std::max(1u, (unsigned int)(width * RenderScale + 0.5f)),
+                      std::max(1u, (unsigned int)(height * RenderScale + 0.5f)));
 }
 
 void PostProcessor::Resize(unsigned int width, unsigned int height) {
-    Width = width;
-    Height = height;
+    // Minimized windows report 0x0; keep the current targets
+    if (width == 0 || height == 0) return;
+
+    glm::uvec2 renderSize = GetScaledSize(width, height);
+    OutputWidth = width;
+    OutputHeight = height;
+    Width = renderSize.x;
+    Height = renderSize.y;
+    ResizePending = false;
+
+    // Shrinking (or growing within capacity) reuses the existing targets
+    if (Width <= CapacityWidth && Height <= CapacityHeight) return;
+
+    CapacityWidth = std::max(CapacityWidth, RoundUpCapacity(Width));
+    CapacityHeight = std::max(CapacityHeight, RoundUpCapacity(Height));
+    std::cout << "PostProcessor: Growing render targets to " << CapacityWidth << "x" << CapacityHeight << std::endl;
 
     // Re-create framebuffers
-    glDeleteFramebuffers(1, &MSAAFBO);
-    glDeleteTextures(1, &MSAATexture);
-    glDeleteTextures(1, &MSAADepthTexture);
+    ReleaseFramebuffers();
+    InitFramebuffers();
+}
 
-    glDeleteFramebuffers(1, &DepthCopyFBO);
-    glDeleteTextures(1, &MSAADepthCopyTexture);
-    glDeleteTextures(1, &MSAADummyColorTexture);
+void PostProcessor::RequestResize(unsigned int width, unsigned int height, double time) {
+    if (width == 0 || height == 0) return;
 
-    glDeleteFramebuffers(1, &LowResGasFBO);
-    glDeleteFramebuffers(1, &LowResDepthFBO);
-    glDeleteTextures(1, &LowResGasTexture);
-    glDeleteTextures(1, &LowResDepthTexture);
+    glm::uvec2 renderSize = GetScaledSize(width, height);
+    if (renderSize.x <= CapacityWidth && renderSize.y <= CapacityHeight) {
+        Resize(width, height);
+        return;
+    }
 
-    glDeleteFramebuffers(1, &IntermediateFBO);
-    glDeleteTextures(1, &ScreenTexture);
-    glDeleteTextures(1, &DepthTexture);
+    // Too large for the current targets: keep rendering into them at the largest size that
+    // preserves the new aspect ratio, and reallocate once the size stops changing.
+    OutputWidth = width;
+    OutputHeight = height;
+    float fit = std::min((float)CapacityWidth / renderSize.x, (float)CapacityHeight / renderSize.y);
+    Width = std::max(1u, (unsigned int)(renderSize.x * fit));
+    Height = std::max(1u, (unsigned int)(renderSize.y * fit));
 
-    glDeleteFramebuffers(1, &ResolvedDepthCopyFBO);
-    glDeleteTextures(1, &ResolvedDepthCopyTexture);
+    ResizePending = true;
+    ResizeRequestTime = time;
+}
 
-    glDeleteFramebuffers(1, &MipChainFBO);
-    for (auto& mip : mipChain) {
-        glDeleteTextures(1, &mip.texture);
+void PostProcessor::Update(double time) {
+    if (ResizePending && time - ResizeRequestTime >= RESIZE_DEBOUNCE_SECONDS) {
+        Resize(OutputWidth, OutputHeight);
     }
-    mipChain.clear();
+}
 
-    InitFramebuffers();
+glm::vec2 PostProcessor::GetRenderUVScale() const {
+    return glm::vec2((float)Width / CapacityWidth, (float)Height / CapacityHeight);
+}
+
+glm::vec2 PostProcessor::GetActiveMaxUV(glm::ivec2 activeSize, glm::ivec2 allocatedSize) {
+    return (glm::vec2(activeSize) - 0.5f) / glm::vec2(allocatedSize);
+}
+
+glm::ivec2 PostProcessor::GetMipRenderSize(size_t i) const {
+    // Same halving as InitBloomMips, applied to the active render size
+    glm::ivec2 size((int)Width, (int)Height);
+    for (size_t level = 0; level <= i; level++) {
+        size /= 2;
+    }
+    return glm::max(size, glm::ivec2(1));
+}
+
+size_t PostProcessor::GetActiveMipCount() const {
+    return std::min(mipChain.size(), (size_t)BloomMipCount);
+}
+
+glm::ivec2 PostProcessor::GetLowResRenderSize() const {
+    return glm::ivec2((int)Width / LowResFactor, (int)Height / LowResFactor);
 }
 
 void PostProcessor::CopyDepth() {
+    if (MSAAFBO == 0) return;
+
     // Copy MSAA Depth -> MSAA Depth Copy
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, MSAAFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DepthCopyFBO);
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, MSAAFBO);
+    GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, DepthCopyFBO);
     glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
     // Restore render target
-    glBindFramebuffer(GL_FRAMEBUFFER, MSAAFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, MSAAFBO);
 }
@@ -7,40 +7,62 @@
 
 struct BloomMip {
     unsigned int texture;
-    glm::ivec2 size;
+    glm::ivec2 size; // Allocated size (derived from capacity, not the active render size)
 };
 
 class PostProcessor {
 public:
-    static constexpr float LOW_RES_SCALE = 0.25f;
-
-    unsigned int Width, Height;
+    // Low-res gas targets are allocated for the finest factor (half resolution); the active
+    // factor is a quality setting
+    static constexpr int MIN_LOW_RES_FACTOR = 2;
+    static constexpr int MAX_BLOOM_MIPS = 6;
+    // Internal resolution range, as a fraction of the output size
+    static constexpr float MIN_RENDER_SCALE = 0.5f;
+    static constexpr float MAX_RENDER_SCALE = 1.0f;
+    static constexpr float RCAS_SHARPNESS = 0.8f; // Lobe scale of the sharpening after upscaling
+    // How long the requested size must be stable before growing the render targets
+    static constexpr double RESIZE_DEBOUNCE_SECONDS = 0.25;
+
+    unsigned int Width, Height; // Active render size (viewport inside the render targets)
+    unsigned int OutputWidth, OutputHeight; // Size of the default framebuffer we composite to
+    unsigned int CapacityWidth, CapacityHeight; // Allocated size of the render targets (only grows)
 
     // Framebuffers
-    unsigned int MSAAFBO; // Multisampled FBO
-    unsigned int MSAATexture; // Multisampled Color Buffer
-    unsigned int MSAADepthTexture; // Multisampled Depth Buffer
+    // The multisampled targets only exist while the quality level enables MSAA (0 otherwise)
+    unsigned int MSAAFBO = 0; // Multisampled FBO
+    unsigned int MSAATexture = 0; // Multisampled Color Buffer
+    unsigned int MSAADepthTexture = 0; // Multisampled Depth Buffer
 
     // Depth Copy for Soft Particles (Breaks Feedback Loop)
-    unsigned int DepthCopyFBO;
-    unsigned int MSAADepthCopyTexture;
-    unsigned int MSAADummyColorTexture; // Required to make FBO Complete on some drivers
+    unsigned int DepthCopyFBO = 0;
+    unsigned int MSAADepthCopyTexture = 0;
+    unsigned int MSAADummyColorTexture = 0; // Required to make FBO Complete on some drivers
 
-    // Low-Resolution Gas Rendering (Quarter Resolution)
-    // Separated FBOs to avoid feedback loops
+    // Low-Resolution Gas Rendering (1/2, 1/4 or 1/8 Resolution)
     unsigned int LowResGasFBO;   // For drawing gas (Color Att 0: LowResGasTexture)
-    unsigned int LowResDepthFBO; // For downsampling depth (Color Att 0: LowResDepthTexture)
 
     unsigned int LowResGasTexture; // RGB16F
-    unsigned int LowResDepthTexture; // R32F (Linear Depth)
+    unsigned int LowResDepthTexture; // RG32F (Min/Max Linear Depth, written by the depth resolve)
 
     unsigned int IntermediateFBO; // Intermediate FBO for resolving MSAA
     unsigned int ScreenTexture; // Texture attachment for Intermediate FBO
     unsigned int DepthTexture; // Resolved Depth Texture
 
-    // Single-sample depth copy for reading in shaders while testing against DepthTexture
-    unsigned int ResolvedDepthCopyFBO;
-    unsigned int ResolvedDepthCopyTexture;
+    // Full-res linear depth (R32F), written by the depth resolve for reading in shaders
+    // while testing against DepthTexture
+    unsigned int LinearDepthTexture;
+
+    // Offscreen composite target (headless runs, GPU-side capture); 0 composites to the default framebuffer
+    unsigned int OutputFBO = 0;
+    unsigned int OutputTexture = 0; // RGBA8, Output size
+
+    // Spatial upscaling, used while the render size is smaller than the output size (render
+    // scale below 1, or a debounced resize): the composite is tonemapped at the render size,
+    // upscaled (EASU) to the output size and sharpened (RCAS) into the output
+    unsigned int UpscaleSourceFBO;
+    unsigned int UpscaleSourceTexture; // RGBA8, capacity size (tonemapped composite)
+    unsigned int UpscaledFBO = 0;
+    unsigned int UpscaledTexture = 0; // RGBA8, Output size (EASU result)
 
     // Bloom Mip Chain
     unsigned int MipChainFBO;
@@ -50,36 +72,125 @@ public:
     std::unique_ptr<Shader> downsampleShader;
     std::unique_ptr<Shader> upsampleShader;
     std::unique_ptr<Shader> gasCompositeShader;
-    std::unique_ptr<Shader> depthDownsampleShader;
+    std::unique_ptr<Shader> depthResolveShader; // Compute
+    std::unique_ptr<Shader> depthResolveSingleSampleShader; // Compute, opaque pass without MSAA
+    std::unique_ptr<Shader> easuShader;
+    std::unique_ptr<Shader> rcasShader;
 
     unsigned int QuadVAO = 0;
     unsigned int QuadVBO;
 
-    PostProcessor(unsigned int width, unsigned int height);
+    // width, height: output size. The render targets are allocated for it at renderScale
+    PostProcessor(unsigned int width, unsigned int height, float renderScale = MAX_RENDER_SCALE);
     ~PostProcessor();
 
     // Prevent copying to avoid double-free of OpenGL resources
     PostProcessor(const PostProcessor&) = delete;
     PostProcessor& operator=(const PostProcessor&) = delete;
 
-    void BeginRender();
-    // Resolves MSAA Opaque pass to Intermediate FBO for Transparent rendering
+    // Quality settings (QualityGovernor), applied from the next BeginRender:
+    //   msaa: opaque pass in the 4x MSAA target, otherwise straight into the Intermediate FBO
+    //         (the MSAA targets are freed, and allocated again when a level turns it back on)
+    //   lowResFactor: full-res pixels per luminous gas pixel (2, 4 or 8)
+    //   bloomMips: active levels of the bloom chain (1..MAX_BLOOM_MIPS)
+    void SetQuality(bool msaa, int lowResFactor, int bloomMips);
+    int GetLowResFactor() const { return LowResFactor; }
+    // Internal resolution as a fraction of the output size (clamped to MIN/MAX_RENDER_SCALE).
+    // Takes effect immediately, growing the render targets if needed
+    void SetRenderScale(float scale);
+    float GetRenderScale() const { return RenderScale; }
+
+    // renderOpaque = false when no opaque geometry will be drawn this frame: the MSAA target
+    // is skipped and rendering starts directly in the single-sample Intermediate FBO
+    void BeginRender(bool renderOpaque = true);
+    // Resolves MSAA Opaque pass to Intermediate FBO for Transparent rendering and
+    // builds the full-res and low-res linear depth textures
     void PerformOpaqueResolve();
+    // Builds the bloom chain and composites
     void EndRender();
-
-    // Quarter-Resolution Gas Pass
-    void PrepareGasPass(); // Downsamples depth
+    // Composites the scene and bloom of the last EndRender again, without rendering them.
+    // Only valid while HasScene()
+    void Composite();
+    // False until a frame is rendered into the current targets
+    bool HasScene() const { return SceneRendered; }
+    // Zeroes the scene and bloom targets, including the area outside the active render size.
+    // Gives the render scale check (--check-render-scale) a reference without stale pixels
+    void ClearSceneTargets();
+
+    // Low-Resolution Gas Pass
     void BeginGasPass();
     void EndGasPass();
 
+    // Resizes the output immediately, growing the render targets if the scaled render size
+    // exceeds capacity
     void Resize(unsigned int width, unsigned int height);
-
-    // Copies the multisampled depth buffer to a second texture to allow reading while writing
+    // Called from the window resize callback. Sizes that fit the current capacity apply
+    // immediately; growth is debounced and rendered with a scaled viewport until it settles.
+    void RequestResize(unsigned int width, unsigned int height, double time);
+    // Applies a pending debounced resize once the size has been stable long enough
+    void Update(double time);
+
+    // Composites into OutputFBO instead of the default framebuffer (no window / surfaceless context).
+    // present: a window still shows the frame, copied over by PresentOutput
+    void EnableOffscreenOutput(bool present = false);
+    // Blits OutputFBO to the window if presenting, then leaves the default framebuffer bound
+    void PresentOutput();
+
+    // Copies the multisampled depth buffer to a second texture to allow reading while writing.
+    // Does nothing while the MSAA targets aren't allocated
     void CopyDepth();
     unsigned int GetDepthTexture() const { return DepthTexture; }
 
 private:
+    // Per-frame uniforms, resolved once after the shaders are built
+    Uniform<glm::vec2> DownsampleSrcResolution, DownsampleUVScale, DownsampleMaxUV;
+    Uniform<glm::vec2> UpsampleUVScale, UpsampleMaxUV;
+    Uniform<glm::vec2> PostUVScale, PostBloomMaxUV;
+    Uniform<float> GasCompositeLowResScale;
+    Uniform<glm::vec2> EasuSourceSize, EasuOutputSize;
+    Uniform<glm::ivec2> DepthResolveLowResSize, DepthResolveSingleSampleLowResSize;
+    Uniform<int> DepthResolveLowResFactor, DepthResolveSingleSampleLowResFactor;
+
+    bool MSAAEnabled = true;
+    int LowResFactor = 4; // Quarter resolution
+    int BloomMipCount = MAX_BLOOM_MIPS;
+    float RenderScale = MAX_RENDER_SCALE;
+
+    bool ResizePending = false;
+    double ResizeRequestTime = 0.0;
+
+    unsigned int OutputTargetWidth = 0, OutputTargetHeight = 0; // Allocated size of OutputTexture
+    unsigned int UpscaledTargetWidth = 0, UpscaledTargetHeight = 0; // Allocated size of UpscaledTexture
+    bool PresentToScreen = false;
+
+    bool OpaquePassActive = true; // Opaque pass in use this frame
+    bool OpaquePassMSAA = true; // ... rendered into the MSAA target
+    bool LinearDepthCleared = false; // Linear depth textures hold the far plane (no opaque geometry)
+    bool SceneRendered = false; // ScreenTexture and the bloom chain hold a finished frame
+
     void InitRenderData();
     void InitFramebuffers();
     void InitBloomMips();
+    void ReleaseFramebuffers();
+    void InitMSAATargets();
+    void ReleaseMSAATargets();
+    void InitOutputTarget();
+    void ReleaseOutputTarget();
+    void InitUpscaledTarget();
+    void ReleaseUpscaledTarget();
+
+    // Render size for an output size at the current render scale
+    glm::uvec2 GetScaledSize(unsigned int width, unsigned int height) const;
+
+    // Fraction of the allocated targets covered by the active render size
+    glm::vec2 GetRenderUVScale() const;
+    // Texture coordinate of the last active texel center. Filter taps are clamped to it:
+    // outside the active region the targets hold stale pixels from a larger frame
+    static glm::vec2 GetActiveMaxUV(glm::ivec2 activeSize, glm::ivec2 allocatedSize);
+    // Active (viewport) size of bloom mip i, derived from the active render size
+    glm::ivec2 GetMipRenderSize(size_t i) const;
+    // Bloom levels built this frame (the chain may be shorter for tiny targets)
+    size_t GetActiveMipCount() const;
+    // Active size of the low-res gas targets
+    glm::ivec2 GetLowResRenderSize() const;
 };
@@ -0,0 +1,143 @@
+#include "ProgramCache.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+static bool g_cacheEnabled = false;
+static std::filesystem::path g_cacheDirectory;
+static std::string g_driverString; // Vendor | renderer | version
+
+static const uint32_t CACHE_MAGIC = 0x42504C47; // "GLPB"
+
+// 64-bit FNV-1a
+static uint64_t hashBytes(const char* data, size_t length, uint64_t hash = 0xcbf29ce484222325ull) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static std::filesystem::path entryPath(const std::string& key) {
+    return g_cacheDirectory / (key + ".bin");
+}
+
+void initProgramCache(const std::string& directory) {
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        std::cout << "ProgramCache: Driver exposes no program binary formats, cache disabled" << std::endl;
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "ProgramCache: Failed to create " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+
+    auto glString = [](GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? std::string((const char*)value) : std::string();
+    };
+    g_driverString = glString(GL_VENDOR) + " | " + glString(GL_RENDERER) + " | " + glString(GL_VERSION);
+    g_cacheDirectory = directory;
+    g_cacheEnabled = true;
+}
+
+std::string programCacheKey(const std::vector<const char*>& sources) {
+    uint64_t hash = hashBytes(g_driverString.data(), g_driverString.size());
+    for (const char* source : sources) {
+        // Terminator included so stage boundaries are part of the key
+        hash = hashBytes(source, strlen(source) + 1, hash);
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+    return key;
+}
+
+unsigned int loadCachedProgram(const std::string& key) {
+    if (!g_cacheEnabled) return 0;
+
+    std::filesystem::path path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    // Entry: magic, binary format, length, binary
+    uint32_t magic = 0, format = 0, length = 0;
+    file.read((char*)&magic, sizeof(magic));
+    file.read((char*)&format, sizeof(format));
+    file.read((char*)&length, sizeof(length));
+    bool valid = file && magic == CACHE_MAGIC && length > 0;
+
+    // The length is only trusted once it matches the bytes after the header, so a corrupt
+    // entry can't ask for a huge allocation
+    if (valid) {
+        std::error_code error;
+        uintmax_t fileSize = std::filesystem::file_size(path, error);
+        const uintmax_t headerSize = 3 * sizeof(uint32_t);
+        valid = !error && fileSize >= headerSize && fileSize - headerSize == length;
+    }
+
+    std::vector<char> binary;
+    if (valid) {
+        binary.resize(length);
+        file.read(binary.data(), binary.size());
+        valid = (bool)file;
+    }
+    file.close();
+
+    if (valid) {
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, (GLenum)format, binary.data(), (GLsizei)length);
+
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (success) return program;
+        glDeleteProgram(program);
+    }
+
+    // Truncated or corrupt entry, or a binary the driver no longer accepts: rebuild from source
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
+
+void storeCachedProgram(const std::string& key, unsigned int program) {
+    if (!g_cacheEnabled) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    // Write to a temporary file first so a crash never leaves a truncated entry behind
+    std::filesystem::path path = entryPath(key);
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        uint32_t header[3] = { CACHE_MAGIC, (uint32_t)format, (uint32_t)length };
+        file.write((const char*)header, sizeof(header));
+        file.write(binary.data(), binary.size());
+        if (!file) {
+            std::cerr << "ProgramCache: Failed to write " << tempPath.string() << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+    }
+}
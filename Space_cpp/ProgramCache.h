@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by a hash of all stage sources and the driver's vendor/renderer/version,
+// so a driver update or an edited shader simply misses. A binary the driver rejects is
+// deleted and the program is rebuilt from source; callers never see the difference.
+
+// Enables the cache in directory (created if missing). Needs a current context.
+// Without this call (or if the driver exposes no binary formats) every lookup misses.
+void initProgramCache(const std::string& directory);
+
+// Key for a program built from these stage sources
+std::string programCacheKey(const std::vector<const char*>& sources);
+
+// Returns a linked program loaded from the cache, or 0 on a miss
+unsigned int loadCachedProgram(const std::string& key);
+
+// Stores a linked program (link with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set)
+void storeCachedProgram(const std::string& key, unsigned int program);
@@ -0,0 +1,111 @@
+#include "QualityGovernor.h"
+#include <iostream>
+#include <algorithm>
+
+const QualitySettings QualityGovernor::LEVELS[LEVEL_COUNT] = {
+    // Name       Star flux  Star LOD  Gas LOD area  Gas factor  Bloom mips  MSAA   Render scale
+    { "Ultra",    0.15f,     0.0f,     16.0f,        2,          6,          true,  1.0f  },
+    { "High",     0.25f,     1.0f,     64.0f,        4,          6,          true,  1.0f  },
+    { "Medium",   0.3f,      1.5f,     128.0f,       4,          5,          true,  0.85f },
+    { "Low",      0.35f,     2.0f,     256.0f,       4,          4,          false, 0.7f  },
+    { "Minimal",  0.4f,      3.0f,     512.0f,       8,          3,          false, 0.5f  },
+};
+
+QualityGovernor::QualityGovernor(double budgetMs) : BudgetMs(budgetMs) {
+    if (!Enabled()) return;
+
+    for (Query& query : Queries) {
+        glGenQueries(1, &query.id);
+    }
+    std::cout << "QualityGovernor: " << BudgetMs << " ms GPU budget, starting at " << Settings().Name << std::endl;
+}
+
+QualityGovernor::~QualityGovernor() {
+    for (Query& query : Queries) {
+        if (query.id) glDeleteQueries(1, &query.id);
+    }
+}
+
+void QualityGovernor::BeginScene() {
+    if (!Enabled()) return;
+
+    // Every query still in flight: this frame goes untimed rather than waiting
+    Query& query = Queries[NextQuery];
+    if (query.pending) return;
+
+    glBeginQuery(GL_TIME_ELAPSED, query.id);
+    query.level = CurrentLevel;
+    Timing = true;
+}
+
+void QualityGovernor::EndScene() {
+    if (!Timing) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    Queries[NextQuery].pending = true;
+    NextQuery = (NextQuery + 1) % QUERY_COUNT;
+    Timing = false;
+}
+
+void QualityGovernor::Update() {
+    if (!Enabled()) return;
+
+    // 1. Collect finished timings, oldest first
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        Query& query = Queries[(NextQuery + i) % QUERY_COUNT];
+        if (!query.pending) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsedNs);
+        query.pending = false;
+
+        // Frames rendered before the last change say nothing about this level, and the first
+        // one at a level pays for the change (lazily compiled variants, first use of targets)
+        if (query.level != CurrentLevel) continue;
+        if (!WarmedUp) {
+            WarmedUp = true;
+            continue;
+        }
+
+        // Clamped, so one hitch moves the average by a bounded step
+        double ms = std::min(elapsedNs / 1.0e6, BudgetMs * MAX_SAMPLE_BUDGETS);
+        SmoothedMs = SmoothedMs < 0.0 ? ms : SmoothedMs + (ms - SmoothedMs) * SMOOTHING;
+        SamplesAtLevel++;
+    }
+
+    if (SamplesAtLevel < SETTLE_SAMPLES) return;
+
+    // 2. Over budget: step down, and back off if this undoes a step up
+    if (SmoothedMs > BudgetMs) {
+        if (CurrentLevel == LEVEL_COUNT - 1) return;
+        if (SteppedUp) StepUpWait = std::min(StepUpWait * 2, MAX_STEP_UP_WAIT);
+        SteppedUp = false;
+        SetLevel(CurrentLevel + 1);
+        return;
+    }
+
+    // 3. A step up that held as long as it was waited for is kept
+    if (SteppedUp && SamplesAtLevel >= StepUpWait) {
+        SteppedUp = false;
+        StepUpWait = SETTLE_SAMPLES;
+    }
+
+    // 4. Well under budget: step up
+    if (SmoothedMs < BudgetMs * STEP_UP_HEADROOM && CurrentLevel > 0 && SamplesAtLevel >= StepUpWait) {
+        SetLevel(CurrentLevel - 1);
+        SteppedUp = true;
+    }
+}
+
+void QualityGovernor::SetLevel(int level) {
+    std::cout << "QualityGovernor: " << Settings().Name << " -> " << LEVELS[level].Name
+              << " (scene " << SmoothedMs << " ms GPU)" << std::endl;
+    CurrentLevel = level;
+    SmoothedMs = -1.0;
+    SamplesAtLevel = 0;
+    WarmedUp = false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <glad/glad.h>
+
+// Runtime LOD knobs of one quality level
+struct QualitySettings {
+    const char* Name;
+    float StarFluxThreshold; // Stars dimmer than this (mapped brightness) go to the flux image instead of sprites
+    float StarLodBrightness; // Stars dimmer than this are thinned stochastically (0 = off)
+    float GasLodArea;        // Projected area (px^2) below which gas clouds are thinned stochastically
+    int GasLowResFactor;     // Full-res pixels per luminous gas pixel (2, 4 or 8)
+    int BloomMips;           // Active bloom levels
+    bool MSAA;               // 4x MSAA opaque pass
+    float RenderScale;       // Internal resolution (fraction of the output, spatially upscaled)
+};
+
+// Keeps the scene's GPU time under a frame budget by stepping through fixed quality levels.
+// The scene render is timed with GL_TIME_ELAPSED queries, read back a few frames later so the
+// CPU never waits on them, and smoothed with an exponential moving average. Hysteresis keeps
+// the level from flickering: it steps down once the smoothed time exceeds the budget, and up
+// only with STEP_UP_HEADROOM to spare. A step up that has to be undone doubles the wait before
+// the next one. Every change waits for SETTLE_SAMPLES samples taken at the new level.
+//
+// Frames that reuse the cached scene (RenderInputs unchanged) aren't timed: they cost
+// little more than the composite and say nothing about the level.
+class QualityGovernor {
+public:
+    static constexpr int LEVEL_COUNT = 5;
+    static constexpr int DEFAULT_LEVEL = 1; // Held while the governor is off
+    static constexpr int QUERY_COUNT = 4;   // Frames in flight before a timing is read
+    static constexpr double SMOOTHING = 0.1;
+    static constexpr double MAX_SAMPLE_BUDGETS = 4.0; // Samples are clamped to this many budgets
+    static constexpr double STEP_UP_HEADROOM = 0.7; // Fraction of the budget to step up below
+    static constexpr int SETTLE_SAMPLES = 20;
+    static constexpr int MAX_STEP_UP_WAIT = 640;
+
+    // Best first
+    static const QualitySettings LEVELS[LEVEL_COUNT];
+
+    // budgetMs <= 0 holds DEFAULT_LEVEL and times nothing
+    explicit QualityGovernor(double budgetMs);
+    ~QualityGovernor();
+
+    QualityGovernor(const QualityGovernor&) = delete;
+    QualityGovernor& operator=(const QualityGovernor&) = delete;
+
+    // Bracket the GPU work of one scene render (no nesting with other time queries)
+    void BeginScene();
+    void EndScene();
+    // Collects finished timings and picks the level for the next frame
+    void Update();
+
+    bool Enabled() const { return BudgetMs > 0.0; }
+    int Level() const { return CurrentLevel; }
+    const QualitySettings& Settings() const { return LEVELS[CurrentLevel]; }
+    // Smoothed GPU time of the scene (ms), negative before the first sample at this level
+    double SmoothedGpuMs() const { return SmoothedMs; }
+
+private:
+    struct Query {
+        unsigned int id = 0;
+        bool pending = false;
+        int level = 0; // Level the timed frame rendered at
+    };
+
+    double BudgetMs;
+    int CurrentLevel = DEFAULT_LEVEL;
+    double SmoothedMs = -1.0;
+    int SamplesAtLevel = 0;
+    bool WarmedUp = false;           // The first sample at the current level was discarded
+    int StepUpWait = SETTLE_SAMPLES; // Samples to wait at a level before stepping up
+    bool SteppedUp = false;          // The current level was reached by stepping up
+
+    Query Queries[QUERY_COUNT];
+    int NextQuery = 0;
+    bool Timing = false; // Between BeginScene and EndScene with a query running
+
+    void SetLevel(int level);
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// What the cached GPU results depend on. The culling passes keep their compacted buffers,
+// and the PostProcessor its scene and bloom images, while the inputs they were computed
+// from match the current frame's. A paused, still view then costs little more than the
+// final composite and the UI.
+struct RenderInputs {
+    glm::mat4 view = glm::mat4(0.0f);
+    glm::mat4 projection = glm::mat4(0.0f);
+    double time = -1.0;                    // Simulation time (stands still while paused)
+    glm::ivec2 renderSize = glm::ivec2(0); // Active render size
+    unsigned int sceneVersion = 0;         // Bumped whenever galaxy data is regenerated
+    int qualityLevel = -1;                 // QualityGovernor level (LOD thresholds, targets)
+
+    // Camera and time only (what positions and visibility depend on)
+    bool SameView(const RenderInputs& other) const {
+        return view == other.view && projection == other.projection && time == other.time;
+    }
+
+    // Everything but time: a cull can reuse its rejections (CullSlicer)
+    bool SameExceptTime(const RenderInputs& other) const {
+        return view == other.view && projection == other.projection && renderSize == other.renderSize &&
+               sceneVersion == other.sceneVersion && qualityLevel == other.qualityLevel;
+    }
+
+    bool operator==(const RenderInputs& other) const {
+        return SameExceptTime(other) && time == other.time;
+    }
+    bool operator!=(const RenderInputs& other) const { return !(*this == other); }
+};
+
+// The current frame's inputs, set by main before any pass runs
+extern RenderInputs g_renderInputs;
@@ -1,77 +1,121 @@
 #include "Shader.h"
+#include "ShaderLibrary.h"
+#include "ProgramCache.h"
+#include "GLState.h"
 #include <stdexcept>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    }
-    catch (std::ifstream::failure& e) {
-        throw std::runtime_error(std::string("ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: ") + e.what());
-    }
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1 // GL_KHR_parallel_shader_compile
+#endif
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines) {
+    // 1. retrieve the vertex/fragment source code (includes resolved, variant defines injected)
+    std::vector<std::string> vertexFiles, fragmentFiles;
+    std::string vertexCode = ShaderLibrary::LoadSource(vertexPath, defines, &vertexFiles);
+    std::string fragmentCode = ShaderLibrary::LoadSource(fragmentPath, defines, &fragmentFiles);
 
-    compile(vertexCode.c_str(), fragmentCode.c_str());
+    build({ { GL_VERTEX_SHADER, "VERTEX", vertexCode, vertexFiles },
+             { GL_FRAGMENT_SHADER, "FRAGMENT", fragmentCode, fragmentFiles } });
+}
+
+Shader::Shader(const char* computePath, const std::vector<std::string>& defines) {
+    std::vector<std::string> computeFiles;
+    std::string computeCode = ShaderLibrary::LoadSource(computePath, defines, &computeFiles);
+
+    build({ { GL_COMPUTE_SHADER, "COMPUTE", computeCode, computeFiles } });
 }
 
 Shader::Shader(std::string vertexCode, std::string fragmentCode, bool isCode) {
-    compile(vertexCode.c_str(), fragmentCode.c_str());
+    build({ { GL_VERTEX_SHADER, "VERTEX", vertexCode, {} },
+             { GL_FRAGMENT_SHADER, "FRAGMENT", fragmentCode, {} } });
 }
 
 Shader::~Shader() {
+    if (!pendingStages.empty()) {
+        ShaderLibrary::Forget(this);
+        releaseStages();
+    }
     if (ID != 0) {
         glDeleteProgram(ID);
         ID = 0;
     }
 }
 
-void Shader::compile(const char* vShaderCode, const char* fShaderCode) {
-    unsigned int vertex, fragment;
-
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+void Shader::build(const std::vector<StageSource>& stages) {
+    // 0. Reuse the linked binary from a previous run
+    std::vector<const char*> sources;
+    for (const StageSource& stage : stages) {
+        sources.push_back(stage.code.c_str());
+    }
+    cacheKey = programCacheKey(sources);
+    ID = loadCachedProgram(cacheKey);
+    if (ID != 0) return;
 
-    // shader Program
+    // 1. Submit compile and link without querying any status: the driver may build on
+    // background threads until Finalize asks for the result
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    for (const StageSource& stage : stages) {
+        const char* code = stage.code.c_str();
+        unsigned int shader = glCreateShader(stage.type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        glAttachShader(ID, shader);
+
+        std::string name = stage.name;
+        for (size_t i = 0; i < stage.files.size(); i++) {
+            name += (i == 0 ? " (" : ", ") + std::to_string(i) + ": " + stage.files[i];
+        }
+        if (!stage.files.empty()) name += ")";
+        pendingStages.push_back({ shader, name });
+    }
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+
+    // 2. Check now, or when the batch ends
+    if (ShaderLibrary::IsBatching()) {
+        ShaderLibrary::Defer(this);
+    } else {
+        Finalize();
+    }
+}
+
+bool Shader::IsReady() const {
+    if (pendingStages.empty()) return true;
+    if (!ShaderLibrary::HasCompletionQuery()) return false;
+
+    int complete = 0;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
+}
+
+void Shader::Finalize() {
+    if (pendingStages.empty()) return;
+
+    try {
+        for (const PendingStage& stage : pendingStages) {
+            checkCompileErrors(stage.shader, stage.name);
+        }
+        checkCompileErrors(ID, "PROGRAM");
+    } catch (...) {
+        releaseStages();
+        throw;
+    }
 
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    releaseStages();
+    storeCachedProgram(cacheKey, ID);
+}
+
+void Shader::releaseStages() {
+    for (const PendingStage& stage : pendingStages) {
+        glDetachShader(ID, stage.shader);
+        glDeleteShader(stage.shader);
+    }
+    pendingStages.clear();
 }
 
 void Shader::use() {
-    glUseProgram(ID);
+    GLState::UseProgram(ID);
 }
 
 int Shader::getUniformLocation(const std::string& name) const {
@@ -95,6 +139,9 @@ void Shader::setFloat(const std::string& name, float value) const {
 void Shader::setVec2(const std::string& name, float x, float y) const {
     glUniform2f(getUniformLocation(name), x, y);
 }
+void Shader::setIVec2(const std::string& name, int x, int y) const {
+    glUniform2i(getUniformLocation(name), x, y);
+}
 void Shader::setVec3(const std::string& name, float x, float y, float z) const {
     glUniform3f(getUniformLocation(name), x, y, z);
 }
@@ -2,16 +2,39 @@
 
 #include <glad/glad.h>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <vector>
 #include <iostream>
 #include <unordered_map>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Uniform location resolved once (Shader::GetUniform) and set without any string lookup.
+// Goes through glProgramUniform, so the program doesn't have to be bound.
+template <typename T>
+struct Uniform {
+    unsigned int program = 0;
+    int location = -1;
+
+    void Set(const T& value) const;
+};
+
+template <> inline void Uniform<bool>::Set(const bool& value) const { glProgramUniform1i(program, location, (int)value); }
+template <> inline void Uniform<int>::Set(const int& value) const { glProgramUniform1i(program, location, value); }
+template <> inline void Uniform<float>::Set(const float& value) const { glProgramUniform1f(program, location, value); }
+template <> inline void Uniform<glm::vec2>::Set(const glm::vec2& value) const { glProgramUniform2f(program, location, value.x, value.y); }
+template <> inline void Uniform<glm::ivec2>::Set(const glm::ivec2& value) const { glProgramUniform2i(program, location, value.x, value.y); }
+template <> inline void Uniform<glm::vec3>::Set(const glm::vec3& value) const { glProgramUniform3f(program, location, value.x, value.y, value.z); }
+template <> inline void Uniform<glm::vec4>::Set(const glm::vec4& value) const { glProgramUniform4f(program, location, value.x, value.y, value.z, value.w); }
+template <> inline void Uniform<glm::mat4>::Set(const glm::mat4& value) const { glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value)); }
 
 class Shader {
 public:
     unsigned int ID = 0;
 
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // defines ("NAME" or "NAME VALUE") select a variant; see ShaderLibrary.h
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = {});
+    // Compute program
+    explicit Shader(const char* computePath, const std::vector<std::string>& defines = {});
     Shader(std::string vertexCode, std::string fragmentCode, bool isCode = true);
     ~Shader();
 
@@ -20,10 +43,17 @@ public:
     Shader& operator=(const Shader&) = delete;
 
     void use();
+
+    // Resolves a uniform once; keep the handle and Set it in the frame loop
+    template <typename T>
+    Uniform<T> GetUniform(const char* name) const { return { ID, glGetUniformLocation(ID, name) }; }
+
+    // Name-based setters (cached lookup per call): for one-off setup, not per-frame code
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
     void setVec2(const std::string& name, float x, float y) const;
+    void setIVec2(const std::string& name, int x, int y) const;
     void setVec3(const std::string& name, float x, float y, float z) const;
     void setVec4(const std::string& name, float x, float y, float z, float w) const;
     void setMat4(const std::string& name, const float* value) const;
@@ -31,9 +61,30 @@ public:
     // For UBOs
     void setUniformBlock(const std::string& name, unsigned int bindingPoint) const;
 
+    // Link finished (never blocks). Always true once finalized
+    bool IsReady() const;
+    // Checks compile/link status, throwing on errors, and stores the binary in the program cache.
+    // Runs in the constructor, or in ShaderLibrary::EndBatch for shaders created inside a batch
+    void Finalize();
+
 private:
+    struct StageSource {
+        GLenum type;
+        const char* name;
+        const std::string& code;
+        std::vector<std::string> files; // Source string index -> file
+    };
+    struct PendingStage {
+        unsigned int shader;
+        std::string name; // Stage type and source files, for error messages
+    };
+
+    std::vector<PendingStage> pendingStages; // Compiled stages awaiting Finalize
+    std::string cacheKey;
+
     void checkCompileErrors(unsigned int shader, std::string type);
-    void compile(const char* vShaderCode, const char* fShaderCode);
+    void build(const std::vector<StageSource>& stages);
+    void releaseStages();
     int getUniformLocation(const std::string& name) const;
     mutable std::unordered_map<std::string, int> uniformLocationCache;
 };
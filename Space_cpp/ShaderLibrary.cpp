@@ -0,0 +1,143 @@
+#include "ShaderLibrary.h"
+#include "Shader.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+static bool parallelCompileSupported = false;
+static int batchDepth = 0;
+static std::vector<Shader*> pendingShaders;
+
+void ShaderLibrary::Init() {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (name && (strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || strcmp(name, "GL_ARB_parallel_shader_compile") == 0)) {
+            parallelCompileSupported = true;
+            break;
+        }
+    }
+
+    // The thread count defaults to the implementation maximum, so there is nothing else to set
+    std::cout << "ShaderLibrary: Parallel shader compile " << (parallelCompileSupported ? "supported" : "not supported") << std::endl;
+}
+
+static void appendSource(const std::filesystem::path& path, std::vector<std::string>& files,
+                         std::ostringstream& out, bool isRoot, const std::vector<std::string>& defines) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " + path.string());
+    }
+
+    int fileIndex = (int)files.size();
+    files.push_back(path.generic_string());
+    if (!isRoot) {
+        out << "#line 1 " << fileIndex << "\n";
+    }
+    bool definesInjected = defines.empty();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        // Strip CR from CRLF sources so the directive parsing below sees clean lines
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        size_t start = line.find_first_not_of(" \t");
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                throw std::runtime_error("ERROR::SHADER::MALFORMED_INCLUDE: " + path.string() + ":" + std::to_string(lineNumber));
+            }
+
+            std::filesystem::path includePath = (path.parent_path() / line.substr(open + 1, close - open - 1)).lexically_normal();
+            if (std::find(files.begin(), files.end(), includePath.generic_string()) == files.end()) {
+                appendSource(includePath, files, out, false, defines);
+            }
+            // Back to this file's numbering
+            out << "#line " << lineNumber + 1 << " " << fileIndex << "\n";
+            continue;
+        }
+
+        out << line << "\n";
+
+        if (isRoot && lineNumber == 1 && line.compare(0, 8, "#version") == 0) {
+            // Variant defines go right after #version, before anything that could test them
+            for (const std::string& define : defines) {
+                out << "#define " << define << "\n";
+            }
+            out << "#line 2 " << fileIndex << "\n";
+            definesInjected = true;
+        }
+    }
+
+    if (isRoot && !definesInjected) {
+        throw std::runtime_error("ERROR::SHADER::NO_VERSION_FOR_DEFINES: " + path.string());
+    }
+}
+
+std::string ShaderLibrary::LoadSource(const std::string& path, const std::vector<std::string>& defines,
+                                      std::vector<std::string>* files) {
+    std::vector<std::string> localFiles;
+    std::vector<std::string>& fileList = files ? *files : localFiles;
+    fileList.clear();
+
+    std::ostringstream out;
+    appendSource(std::filesystem::path(path).lexically_normal(), fileList, out, true, defines);
+    return out.str();
+}
+
+void ShaderLibrary::BeginBatch() {
+    batchDepth++;
+}
+
+void ShaderLibrary::EndBatch() {
+    if (batchDepth == 0 || --batchDepth > 0) return;
+
+    // Every program in the batch is finalized (and reports its error) even if one fails
+    std::string errors;
+    while (!pendingShaders.empty()) {
+        auto next = pendingShaders.begin();
+        if (parallelCompileSupported) {
+            auto ready = std::find_if(pendingShaders.begin(), pendingShaders.end(), [](Shader* shader) { return shader->IsReady(); });
+            if (ready != pendingShaders.end()) next = ready;
+        }
+
+        Shader* shader = *next;
+        pendingShaders.erase(next);
+        try {
+            shader->Finalize();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            if (errors.empty()) errors = e.what();
+        }
+    }
+
+    if (!errors.empty()) {
+        throw std::runtime_error(errors);
+    }
+}
+
+bool ShaderLibrary::IsBatching() {
+    return batchDepth > 0;
+}
+
+void ShaderLibrary::Defer(Shader* shader) {
+    pendingShaders.push_back(shader);
+}
+
+void ShaderLibrary::Forget(Shader* shader) {
+    pendingShaders.erase(std::remove(pendingShaders.begin(), pendingShaders.end(), shader), pendingShaders.end());
+}
+
+bool ShaderLibrary::HasCompletionQuery() {
+    return parallelCompileSupported;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class Shader;
+
+// Shader source loading and batched compilation.
+//
+// Sources may use #include "path" (relative to the including file; each file is included
+// once per program) and receive #defines from the caller, so one file can be compiled into
+// specialized variants, e.g. Shader("gas.vert", "gas.frag", { "LOW_RES" }).
+//
+// Shaders created between BeginBatch and EndBatch only submit their compile and link; the
+// status checks run in EndBatch. Drivers with GL_KHR_parallel_shader_compile (or threaded
+// compilation) then build the whole batch concurrently instead of one program at a time.
+class ShaderLibrary {
+public:
+    // Detects parallel compile support. Needs a current context
+    static void Init();
+
+    // Reads path, resolving #include and injecting defines ("NAME" or "NAME VALUE") after #version.
+    // files receives the source string index of every file (for #line / compile errors).
+    // Throws std::runtime_error if a file can't be read
+    static std::string LoadSource(const std::string& path, const std::vector<std::string>& defines,
+                                  std::vector<std::string>* files = nullptr);
+
+    // Batches nest; status checks run when the outermost batch ends
+    static void BeginBatch();
+    // Finalizes every pending shader, ready ones first. Throws std::runtime_error if any failed
+    static void EndBatch();
+
+    // Used by Shader
+    static bool IsBatching();
+    static void Defer(Shader* shader);
+    static void Forget(Shader* shader);
+    static bool HasCompletionQuery();
+};
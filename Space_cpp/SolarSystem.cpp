@@ -1,6 +1,8 @@
 #include "SolarSystem.h"
 #include "UI.h"
 #include "Shader.h"
+#include "FrameRing.h"
+#include "GLState.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
@@ -26,10 +28,49 @@ std::vector<Planet> planets;
 
 // Render Resources
 static unsigned int sphereVAO = 0;
-static unsigned int sphereIndexCount = 0;
+static unsigned int impostorVAO = 0; // No attributes: impostor quads are built from gl_VertexID
 static unsigned int orbitVAO = 0;
 static unsigned int orbitPointCount = 0;
 
+// Per-instance data for the instanced body / orbit draws (std430, matches body.vert and orbit.vert)
+struct BodyInstance {
+    glm::vec4 positionRadius; // xyz: center, w: radius
+    glm::vec4 colorKind;      // rgb: atmosphere color, w: 0 = planet, 1 = sun
+    glm::vec4 lightPos;       // xyz: the star lighting this body
+};
+const unsigned int BODY_INSTANCE_BINDING = 3;
+const unsigned int ORBIT_INSTANCE_BINDING = 4;
+
+// Rebuilt every frame from the visible bodies and streamed through the frame ring
+static std::vector<BodyInstance> bodyInstances;
+static std::vector<glm::vec4> orbitInstances; // xyz: center, w: orbit radius
+static unsigned int bodyInstanceSSBO = 0;  // Fallback storage if the ring has no room
+static unsigned int orbitInstanceSSBO = 0;
+
+static unsigned int orbitShaderProgram = 0;
+static Uniform<glm::vec3> orbitColor;
+
+// Sphere mesh LOD levels, finest first. A body uses the first level whose threshold its
+// projected radius (pixels) reaches; smaller bodies are ray-traced impostors.
+struct SphereLOD {
+    unsigned int segments;
+    float minPixelRadius;
+    unsigned int firstIndex, indexCount; // Range in the shared index buffer
+};
+static SphereLOD sphereLODs[] = {
+    { 64, 96.0f, 0, 0 },
+    { 32, 24.0f, 0, 0 },
+    { 16, IMPOSTOR_PIXEL_RADIUS, 0, 0 },
+};
+const int SPHERE_LOD_COUNT = sizeof(sphereLODs) / sizeof(sphereLODs[0]);
+
+// Instances sorted by level (impostors last); each draw reads its bucket via instanceOffset
+static std::vector<BodyInstance> lodBuckets[SPHERE_LOD_COUNT + 1];
+static struct {
+    unsigned int meshProgram = 0, impostorProgram = 0;
+    Uniform<int> meshInstanceOffset, impostorInstanceOffset;
+} bodyUniforms;
+
 void initSolarSystemRender() {
     if (sphereVAO != 0) return;
 
@@ -42,50 +83,57 @@ void initSolarSystemRender() {
     std::vector<float> data;
     std::vector<unsigned int> indices;
 
-    const unsigned int X_SEGMENTS = 64;
-    const unsigned int Y_SEGMENTS = 64;
     const float PI = 3.14159265359f;
 
-    for (unsigned int x = 0; x <= X_SEGMENTS; ++x) {
-        for (unsigned int y = 0; y <= Y_SEGMENTS; ++y) {
-            float xSegment = (float)x / (float)X_SEGMENTS;
-            float ySegment = (float)y / (float)Y_SEGMENTS;
-            float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-            float yPos = std::cos(ySegment * PI);
-            float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-
-            // Pos
-            data.push_back(xPos);
-            data.push_back(yPos);
-            data.push_back(zPos);
-            // Normal
-            data.push_back(xPos);
-            data.push_back(yPos);
-            data.push_back(zPos);
-            // UV
-            data.push_back(xSegment);
-            data.push_back(ySegment);
+    // One vertex/index buffer holds every LOD level; each level is a single strip
+    for (SphereLOD& lod : sphereLODs) {
+        const unsigned int X_SEGMENTS = lod.segments;
+        const unsigned int Y_SEGMENTS = lod.segments;
+        const unsigned int baseVertex = (unsigned int)(data.size() / 8);
+        lod.firstIndex = (unsigned int)indices.size();
+
+        for (unsigned int x = 0; x <= X_SEGMENTS; ++x) {
+            for (unsigned int y = 0; y <= Y_SEGMENTS; ++y) {
+                float xSegment = (float)x / (float)X_SEGMENTS;
+                float ySegment = (float)y / (float)Y_SEGMENTS;
+                float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+                float yPos = std::cos(ySegment * PI);
+                float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+
+                // Pos
+                data.push_back(xPos);
+                data.push_back(yPos);
+                data.push_back(zPos);
+                // Normal
+                data.push_back(xPos);
+                data.push_back(yPos);
+                data.push_back(zPos);
+                // UV
+                data.push_back(xSegment);
+                data.push_back(ySegment);
+            }
         }
-    }
 
-    bool oddRow = false;
-    for (unsigned int y = 0; y < Y_SEGMENTS; ++y) {
-        if (!oddRow) {
-            for (unsigned int x = 0; x <= X_SEGMENTS; ++x) {
-                indices.push_back(y * (X_SEGMENTS + 1) + x);
-                indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-            }
-        } else {
-            for (int x = X_SEGMENTS; x >= 0; --x) {
-                indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-                indices.push_back(y * (X_SEGMENTS + 1) + x);
+        bool oddRow = false;
+        for (unsigned int y = 0; y < Y_SEGMENTS; ++y) {
+            if (!oddRow) {
+                for (unsigned int x = 0; x <= X_SEGMENTS; ++x) {
+                    indices.push_back(baseVertex + y * (X_SEGMENTS + 1) + x);
+                    indices.push_back(baseVertex + (y + 1) * (X_SEGMENTS + 1) + x);
+                }
+            } else {
+                for (int x = X_SEGMENTS; x >= 0; --x) {
+                    indices.push_back(baseVertex + (y + 1) * (X_SEGMENTS + 1) + x);
+                    indices.push_back(baseVertex + y * (X_SEGMENTS + 1) + x);
+                }
             }
+            oddRow = !oddRow;
         }
-        oddRow = !oddRow;
+        lod.indexCount = (unsigned int)indices.size() - lod.firstIndex;
     }
-    sphereIndexCount = (unsigned int)indices.size();
 
-    glBindVertexArray(sphereVAO);
+    // Runs on the first frame that renders the system, so VAO binds go through the tracker
+    GLState::BindVertexArray(sphereVAO);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -99,6 +147,8 @@ void initSolarSystemRender() {
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, (int)stride, (void*)(6 * sizeof(float)));
 
+    glGenVertexArrays(1, &impostorVAO);
+
     // --- Orbits (Unit Circle) ---
     glGenVertexArrays(1, &orbitVAO);
     unsigned int orbitVBO;
@@ -113,7 +163,7 @@ void initSolarSystemRender() {
         orbitData.push_back(sin(angle)); // z
     }
 
-    glBindVertexArray(orbitVAO);
+    GLState::BindVertexArray(orbitVAO);
     glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
     glBufferData(GL_ARRAY_BUFFER, orbitData.size() * sizeof(float), orbitData.data(), GL_STATIC_DRAW);
 
@@ -121,21 +171,71 @@ void initSolarSystemRender() {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
+
+    glCreateBuffers(1, &bodyInstanceSSBO);
+    glCreateBuffers(1, &orbitInstanceSSBO);
 }
 
 void cleanupSolarSystemRender() {
     if (sphereVAO != 0) {
         glDeleteVertexArrays(1, &sphereVAO);
-        sphereVAO = 0;
+        glDeleteVertexArrays(1, &impostorVAO);
+        sphereVAO = impostorVAO = 0;
     }
     if (orbitVAO != 0) {
         glDeleteVertexArrays(1, &orbitVAO);
         orbitVAO = 0;
     }
+    if (bodyInstanceSSBO != 0) {
+        glDeleteBuffers(1, &bodyInstanceSSBO);
+        glDeleteBuffers(1, &orbitInstanceSSBO);
+        bodyInstanceSSBO = orbitInstanceSSBO = 0;
+    }
+}
+
+// Mesh scales used for the sun/planet spheres at a given zoom level
+static float getSunRadius(double zoomLevel)
+{
+    if (zoomLevel > 1000.0) return 0.05f;
+    if (zoomLevel > 500.0) return 0.04f;
+    if (zoomLevel > 100.0) return 0.03f;
+    if (zoomLevel > 10.0) return 0.02f;
+    if (zoomLevel > 1.0) return 0.015f;
+    return 0.01f;
+}
+
+static float getPlanetRadius(double zoomLevel)
+{
+    if (zoomLevel > 500.0) return 0.003f;
+    if (zoomLevel > 100.0) return 0.0025f;
+    return 0.002f;
 }
 
-RenderZone calculateRenderZone(const Camera &camera)
+// Projected radius in pixels of a world-space sphere, or 0 if it lies outside the frustum
+static float projectedPixelRadius(const glm::vec3& center, float radius,
+    const glm::mat4& view, const glm::mat4& projection, int viewportHeight)
+{
+    glm::vec4 viewCenter = view * glm::vec4(center, 1.0f);
+    // View matrix carries the (uniform) camera zoom scale
+    float viewRadius = radius * glm::length(glm::vec3(view[0]));
+    float depth = -viewCenter.z;
+
+    // Entirely behind the near plane
+    if (depth + viewRadius < 0.1f) return 0.0f;
+
+    // Conservative side plane tests (sphere grown by its radius on both axes)
+    float extent = depth + viewRadius;
+    if (fabs(viewCenter.x) - viewRadius > extent / projection[0][0]) return 0.0f;
+    if (fabs(viewCenter.y) - viewRadius > extent / projection[1][1]) return 0.0f;
+
+    // Camera inside or touching the sphere: treat as full screen
+    if (depth <= viewRadius) return (float)viewportHeight;
+
+    return viewRadius * projection[1][1] * 0.5f * viewportHeight / depth;
+}
+
+RenderZone calculateRenderZone(const Camera &camera, const glm::mat4& view, const glm::mat4& projection, int viewportHeight)
 {
     RenderZone zone;
     zone.zoomLevel = camera.zoomLevel;
@@ -166,6 +266,37 @@ RenderZone calculateRenderZone(const Camera &camera)
         zone.renderOrbits = true;
     }
 
+    // Screen-space visibility of the opaque bodies
+    zone.sunPixelRadius = 0.0f;
+    zone.renderOpaque = false;
+    for (int i = 0; i < NUM_PLANETS; i++)
+    {
+        zone.planetPixelRadius[i] = 0.0f;
+        zone.orbitPixelRadius[i] = 0.0f;
+    }
+
+    if (solarSystem.isGenerated)
+    {
+        glm::vec3 sunPos((float)sun.x, (float)sun.y, (float)sun.z);
+        zone.sunPixelRadius = projectedPixelRadius(sunPos, getSunRadius(zone.zoomLevel), view, projection, viewportHeight);
+        zone.renderOpaque = zone.sunPixelRadius >= MIN_BODY_PIXEL_RADIUS;
+
+        float planetRadius = getPlanetRadius(zone.zoomLevel);
+        for (size_t i = 0; i < planets.size() && i < NUM_PLANETS; i++)
+        {
+            const Planet &planet = planets[i];
+            glm::vec3 planetPos((float)planet.x, (float)planet.y, (float)planet.z);
+            zone.planetPixelRadius[i] = projectedPixelRadius(planetPos, planetRadius, view, projection, viewportHeight);
+            if (zone.planetPixelRadius[i] >= MIN_BODY_PIXEL_RADIUS) zone.renderOpaque = true;
+
+            if (zone.renderOrbits)
+            {
+                zone.orbitPixelRadius[i] = projectedPixelRadius(sunPos, (float)planet.orbitRadius, view, projection, viewportHeight);
+                if (zone.orbitPixelRadius[i] >= MIN_ORBIT_PIXEL_RADIUS) zone.renderOpaque = true;
+            }
+        }
+    }
+
     return zone;
 }
 
@@ -232,85 +363,117 @@ void updatePlanets(double deltaTime)
 
 void renderSolarSystem(const RenderZone &zone, const Camera& camera,
     unsigned int sunTexture, unsigned int planetTexture,
-    Shader* sunShader, Shader* planetShader, Shader* orbitShader)
+    Shader* bodyShader, Shader* impostorShader, Shader* orbitShader)
 {
-    if (sphereVAO == 0) initSolarSystemRender();
+    // Nothing covers a pixel (galaxy scale or looking away)
+    if (!zone.renderOpaque) return;
 
-    // --- Render Sun ---
-    sunShader->use();
+    if (sphereVAO == 0) initSolarSystemRender();
 
-    float sunRadius = 0.01f;
-    if (zone.zoomLevel > 1000.0) sunRadius = 0.05f;
-    else if (zone.zoomLevel > 500.0) sunRadius = 0.04f;
-    else if (zone.zoomLevel > 100.0) sunRadius = 0.03f;
-    else if (zone.zoomLevel > 10.0) sunRadius = 0.02f;
-    else if (zone.zoomLevel > 1.0) sunRadius = 0.015f;
+    // Opaque geometry: depth tested and written, no blending
+    GLState::Disable(GL_BLEND);
+    GLState::Enable(GL_DEPTH_TEST);
+    GLState::DepthMask(GL_TRUE);
 
-    // Model Matrix: Translate * Scale
-    glm::mat4 sunModel = glm::mat4(1.0f);
-    sunModel = glm::translate(sunModel, glm::vec3((float)sun.x, (float)sun.y, (float)sun.z));
-    sunModel = glm::scale(sunModel, glm::vec3(sunRadius));
+    // --- Render Sun and Planets (one instanced draw per LOD level) ---
+    // Sub-pixel bodies contribute nothing and are left out of the instance lists
+    for (std::vector<BodyInstance>& bucket : lodBuckets) bucket.clear();
+    auto addBody = [](const BodyInstance& body, float pixelRadius) {
+        int level = 0;
+        while (level < SPHERE_LOD_COUNT && pixelRadius < sphereLODs[level].minPixelRadius) level++;
+        lodBuckets[level].push_back(body);
+    };
 
-    sunShader->setMat4("model", glm::value_ptr(sunModel));
+    glm::vec3 sunPos((float)sun.x, (float)sun.y, (float)sun.z);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, sunTexture);
-    sunShader->setInt("sunTexture", 0);
+    if (zone.sunPixelRadius >= MIN_BODY_PIXEL_RADIUS) {
+        addBody({ glm::vec4(sunPos, getSunRadius(zone.zoomLevel)), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(sunPos, 0.0f) }, zone.sunPixelRadius);
+    }
 
-    glBindVertexArray(sphereVAO);
-    glDrawElements(GL_TRIANGLE_STRIP, sphereIndexCount, GL_UNSIGNED_INT, 0);
+    float planetRadius = getPlanetRadius(zone.zoomLevel);
+    for (size_t i = 0; i < planets.size() && i < NUM_PLANETS; i++)
+    {
+        if (zone.planetPixelRadius[i] < MIN_BODY_PIXEL_RADIUS) continue;
 
-    // --- Render Planets ---
-    planetShader->use();
-    planetShader->setVec3("lightPos", (float)sun.x, (float)sun.y, (float)sun.z);
+        const Planet &planet = planets[i];
+        glm::vec3 planetPos((float)planet.x, (float)planet.y, (float)planet.z);
+        // Simple Atmosphere Color based on planet color
+        glm::vec3 atmosphere(planet.r * 0.5f, planet.g * 0.5f, planet.b * 0.8f);
+        addBody({ glm::vec4(planetPos, planetRadius), glm::vec4(atmosphere, 0.0f), glm::vec4(sunPos, 0.0f) }, zone.planetPixelRadius[i]);
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, planetTexture);
-    planetShader->setInt("planetTexture", 0);
+    bodyInstances.clear();
+    for (const std::vector<BodyInstance>& bucket : lodBuckets) {
+        bodyInstances.insert(bodyInstances.end(), bucket.begin(), bucket.end());
+    }
 
-    for (const auto &planet : planets)
+    if (!bodyInstances.empty())
     {
-        float planetRadius = 0.002f;
-        if (zone.zoomLevel > 1000.0) planetRadius = 0.003f;
-        else if (zone.zoomLevel > 500.0) planetRadius = 0.003f;
-        else if (zone.zoomLevel > 100.0) planetRadius = 0.0025f;
-        else if (zone.zoomLevel > 50.0) planetRadius = 0.002f;
-        else if (zone.zoomLevel > 10.0) planetRadius = 0.002f;
-
-        glm::mat4 planetModel = glm::mat4(1.0f);
-        planetModel = glm::translate(planetModel, glm::vec3((float)planet.x, (float)planet.y, (float)planet.z));
-        planetModel = glm::scale(planetModel, glm::vec3(planetRadius));
-
-        planetShader->setMat4("model", glm::value_ptr(planetModel));
+        if (bodyUniforms.meshProgram != bodyShader->ID || bodyUniforms.impostorProgram != impostorShader->ID) {
+            bodyUniforms.meshProgram = bodyShader->ID;
+            bodyUniforms.impostorProgram = impostorShader->ID;
+            bodyUniforms.meshInstanceOffset = bodyShader->GetUniform<int>("instanceOffset");
+            bodyUniforms.impostorInstanceOffset = impostorShader->GetUniform<int>("instanceOffset");
+        }
 
-        // Simple Atmosphere Color based on planet color
-        planetShader->setVec3("atmosphereColor", planet.r * 0.5f, planet.g * 0.5f, planet.b * 0.8f);
+        // Both programs read the same instance buffer
+        bindFrameStorage(BODY_INSTANCE_BINDING, bodyInstanceSSBO, bodyInstances.data(), bodyInstances.size() * sizeof(BodyInstance));
+
+        // Sampler units are fixed in body.frag
+        GLState::BindTexture(0, planetTexture);
+        GLState::BindTexture(1, sunTexture);
+
+        int firstInstance = 0;
+        bodyShader->use();
+        GLState::BindVertexArray(sphereVAO);
+        for (int level = 0; level < SPHERE_LOD_COUNT; level++) {
+            GLsizei count = (GLsizei)lodBuckets[level].size();
+            if (count > 0) {
+                bodyUniforms.meshInstanceOffset.Set(firstInstance);
+                glDrawElementsInstanced(GL_TRIANGLE_STRIP, sphereLODs[level].indexCount, GL_UNSIGNED_INT,
+                                        (void*)(sphereLODs[level].firstIndex * sizeof(unsigned int)), count);
+                GLState::CountDraw();
+            }
+            firstInstance += count;
+        }
 
-        glDrawElements(GL_TRIANGLE_STRIP, sphereIndexCount, GL_UNSIGNED_INT, 0);
+        // Impostors: a 4-vertex quad each, ray-traced against the sphere (writes depth)
+        GLsizei impostorCount = (GLsizei)lodBuckets[SPHERE_LOD_COUNT].size();
+        if (impostorCount > 0) {
+            impostorShader->use();
+            bodyUniforms.impostorInstanceOffset.Set(firstInstance);
+            GLState::BindVertexArray(impostorVAO);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, impostorCount);
+            GLState::CountDraw();
+        }
     }
 
-    // --- Render Orbits (Modern GL) ---
+    // --- Render Orbits (one instanced draw) ---
     if (zone.renderOrbits && orbitShader)
     {
-        orbitShader->use();
-        orbitShader->setVec3("color", 0.2f, 0.2f, 0.2f); // Dim orbit lines
+        orbitInstances.clear();
+        for (size_t i = 0; i < planets.size() && i < NUM_PLANETS; i++)
+        {
+             // Orbits that collapse to a few pixels (or are off-screen) are skipped
+             if (zone.orbitPixelRadius[i] < MIN_ORBIT_PIXEL_RADIUS) continue;
 
-        glBindVertexArray(orbitVAO);
+             // Unit circle on the XZ plane, centered on the sun and scaled by the orbit radius
+             orbitInstances.push_back(glm::vec4(sunPos, (float)planets[i].orbitRadius));
+        }
 
-        for (const auto &planet : planets)
+        if (!orbitInstances.empty())
         {
-             // Model Matrix for Orbit:
-             // Translate to Sun Position -> Scale by Orbit Radius
-             glm::mat4 orbitModel = glm::mat4(1.0f);
-             orbitModel = glm::translate(orbitModel, glm::vec3((float)sun.x, (float)sun.y, (float)sun.z));
-             // Scale (x, y, z) = (radius, 1, radius) because orbit is on XZ plane
-             orbitModel = glm::scale(orbitModel, glm::vec3((float)planet.orbitRadius, 1.0f, (float)planet.orbitRadius));
-
-             orbitShader->setMat4("model", glm::value_ptr(orbitModel));
-             glDrawArrays(GL_LINE_LOOP, 0, orbitPointCount);
+            orbitShader->use();
+            if (orbitShaderProgram != orbitShader->ID) {
+                orbitShaderProgram = orbitShader->ID;
+                orbitColor = orbitShader->GetUniform<glm::vec3>("color");
+            }
+            orbitColor.Set(glm::vec3(0.2f, 0.2f, 0.2f)); // Dim orbit lines
+            bindFrameStorage(ORBIT_INSTANCE_BINDING, orbitInstanceSSBO, orbitInstances.data(), orbitInstances.size() * sizeof(glm::vec4));
+
+            GLState::BindVertexArray(orbitVAO);
+            glDrawArraysInstanced(GL_LINE_LOOP, 0, orbitPointCount, (GLsizei)orbitInstances.size());
+            GLState::CountDraw();
         }
-        glBindVertexArray(0);
     }
-
-    glUseProgram(0);
 }
@@ -37,12 +37,26 @@ struct SolarSystem {
     bool isGenerated;
 };
 
+// Bodies and orbits smaller than this on screen (radius in pixels) are not drawn
+const float MIN_BODY_PIXEL_RADIUS = 0.5f;
+const float MIN_ORBIT_PIXEL_RADIUS = 2.0f;
+// Bodies smaller than this are ray-traced impostor quads instead of sphere meshes
+const float IMPOSTOR_PIXEL_RADIUS = 6.0f;
+
 struct RenderZone {
     double distanceFromSystem;
     double zoomLevel;
     double solarSystemScaleMultiplier;
     double starBrightnessFade;
     bool renderOrbits;
+
+    // Projected radius in pixels (0 when outside the view frustum)
+    float sunPixelRadius;
+    float planetPixelRadius[NUM_PLANETS];
+    float orbitPixelRadius[NUM_PLANETS];
+
+    // True if any sun/planet/orbit is large enough to draw (selects the MSAA opaque pass)
+    bool renderOpaque;
 };
 
 extern const PlanetData PLANET_DATA[NUM_PLANETS];
@@ -55,9 +69,12 @@ extern std::vector<Planet> planets;
 void initSolarSystemRender();
 void cleanupSolarSystemRender();
 
-RenderZone calculateRenderZone(const Camera& camera);
+// viewportHeight is the active render height, used to project body sizes to pixels
+RenderZone calculateRenderZone(const Camera& camera, const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
 void generateSolarSystem();
 void updatePlanets(double deltaTime);
+// Sun and planets with one instanced draw per sphere LOD level (bodyShader) plus one for the
+// impostors (impostorShader: body shaders built with IMPOSTOR); all orbits in a last one
 void renderSolarSystem(const RenderZone& zone, const Camera& camera,
     unsigned int sunTexture, unsigned int planetTexture,
-    class Shader* sunShader, class Shader* planetShader, class Shader* orbitShader);
+    class Shader* bodyShader, class Shader* impostorShader, class Shader* orbitShader);
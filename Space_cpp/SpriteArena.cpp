@@ -0,0 +1,161 @@
+#include "SpriteArena.h"
+#include "GLState.h"
+#include <iostream>
+#include <cstring>
+
+// GL_KHR_shader_subgroup queries (not in every glad profile)
+#ifndef GL_SUBGROUP_SUPPORTED_STAGES_KHR
+#define GL_SUBGROUP_SUPPORTED_STAGES_KHR 0x9535
+#define GL_SUBGROUP_SUPPORTED_FEATURES_KHR 0x9536
+#endif
+#ifndef GL_SUBGROUP_FEATURE_BASIC_BIT_KHR
+#define GL_SUBGROUP_FEATURE_BASIC_BIT_KHR 0x00000001
+#define GL_SUBGROUP_FEATURE_BALLOT_BIT_KHR 0x00000008
+#endif
+
+struct DrawCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int first;
+    unsigned int baseInstance;
+};
+
+static unsigned int outputBuffer = 0;
+static unsigned int commandBuffer = 0;
+static unsigned int vao = 0;
+static size_t allocatedSprites = 0;
+static size_t capacities[SPRITE_RANGE_COUNT] = {};
+static unsigned int layoutVersion = 0;
+static SpriteArena::Compaction compaction = SpriteArena::Compaction::Workgroup;
+
+static bool subgroupBallotSupported() {
+    bool extension = false;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount && !extension; i++) {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        extension = name && strcmp(name, "GL_KHR_shader_subgroup") == 0;
+    }
+    if (!extension) return false;
+
+    // The extension alone doesn't promise ballot, or any subgroup operation in compute shaders
+    GLint stages = 0, features = 0;
+    glGetIntegerv(GL_SUBGROUP_SUPPORTED_STAGES_KHR, &stages);
+    glGetIntegerv(GL_SUBGROUP_SUPPORTED_FEATURES_KHR, &features);
+    const GLint needed = GL_SUBGROUP_FEATURE_BASIC_BIT_KHR | GL_SUBGROUP_FEATURE_BALLOT_BIT_KHR;
+    return (stages & GL_COMPUTE_SHADER_BIT) && (features & needed) == needed;
+}
+
+void SpriteArena::SelectCompaction(Compaction requested) {
+    bool subgroup = subgroupBallotSupported();
+    if (requested == Compaction::Subgroup && !subgroup) {
+        std::cerr << "SpriteArena: Subgroup ballot not supported, using workgroup compaction" << std::endl;
+    }
+    compaction = (requested != Compaction::Workgroup && subgroup) ? Compaction::Subgroup : Compaction::Workgroup;
+    std::cout << "SpriteArena: " << (compaction == Compaction::Subgroup ? "Subgroup" : "Workgroup") << " cull compaction" << std::endl;
+}
+
+SpriteArena::Compaction SpriteArena::ActiveCompaction() {
+    return compaction;
+}
+
+std::vector<std::string> SpriteArena::CullDefines() {
+    if (compaction == Compaction::Subgroup) return { "APPEND_SUBGROUP" };
+    return {};
+}
+
+static void createArena() {
+    glCreateBuffers(1, &outputBuffer);
+    glCreateBuffers(1, &commandBuffer);
+    glNamedBufferData(commandBuffer, sizeof(DrawCommand) * SPRITE_RANGE_COUNT, nullptr, GL_DYNAMIC_DRAW);
+
+    // Layout matches the packed output sprite (12 bytes total)
+    // struct SpriteRender {
+    //     uint ndcXY;     // 4 bytes (unorm16 x2)
+    //     uint depthSize; // 4 bytes (20-bit view depth, 12-bit log2 size)
+    //     uint color;     // 4 bytes (rgba8)
+    // };
+    glCreateVertexArrays(1, &vao);
+    glVertexArrayVertexBuffer(vao, 0, outputBuffer, 0, (GLsizei)SpriteArena::SPRITE_STRIDE);
+
+    // Attrib 0: NDC (vec2 unpacked from unorm16 x2)
+    glEnableVertexArrayAttrib(vao, 0);
+    glVertexArrayAttribFormat(vao, 0, 2, GL_UNSIGNED_SHORT, GL_TRUE, 0);
+    glVertexArrayAttribBinding(vao, 0, 0);
+
+    // Attrib 1: Color (vec4 unpacked from uint) - offset 8
+    glEnableVertexArrayAttrib(vao, 1);
+    glVertexArrayAttribFormat(vao, 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 8);
+    glVertexArrayAttribBinding(vao, 1, 0);
+
+    // Attrib 2: View depth, size (uint, unpacked in the vertex shaders) - offset 4
+    glEnableVertexArrayAttrib(vao, 2);
+    glVertexArrayAttribIFormat(vao, 2, 1, GL_UNSIGNED_INT, 4);
+    glVertexArrayAttribBinding(vao, 2, 0);
+}
+
+void SpriteArena::Reserve(SpriteRange range, size_t capacity) {
+    if (vao == 0) createArena();
+    if (capacities[range] == capacity && allocatedSprites > 0) return;
+    capacities[range] = capacity;
+
+    // 1. Ranges are packed back to back in enum order
+    DrawCommand commands[SPRITE_RANGE_COUNT];
+    size_t total = 0;
+    for (unsigned int i = 0; i < SPRITE_RANGE_COUNT; i++) {
+        commands[i] = { 0, 1, (unsigned int)total, 0 };
+        total += capacities[i];
+    }
+
+    // 2. Only grows: shrinking ranges (regeneration with fewer particles) keep the allocation
+    if (total > allocatedSprites) {
+        glNamedBufferData(outputBuffer, total * SPRITE_STRIDE, nullptr, GL_DYNAMIC_DRAW);
+        allocatedSprites = total;
+    }
+    glNamedBufferSubData(commandBuffer, 0, sizeof(commands), commands);
+    layoutVersion++;
+}
+
+void SpriteArena::Cleanup() {
+    if (outputBuffer) glDeleteBuffers(1, &outputBuffer);
+    if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    outputBuffer = commandBuffer = vao = 0;
+    allocatedSprites = 0;
+    for (size_t& capacity : capacities) capacity = 0;
+    layoutVersion++;
+}
+
+unsigned int SpriteArena::LayoutVersion() {
+    return layoutVersion;
+}
+
+void SpriteArena::ResetCounts(SpriteRange first, unsigned int count) {
+    // Cleared on the GPU (NULL data = zeros), ordered after the previous draws that read it
+    for (unsigned int i = first; i < first + count; i++) {
+        glClearNamedBufferSubData(commandBuffer, GL_R32UI, i * sizeof(DrawCommand), sizeof(unsigned int),
+                                  GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+}
+
+void SpriteArena::BindForCull() {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, outputBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+}
+
+unsigned int SpriteArena::ReadCount(SpriteRange range) {
+    unsigned int count = 0;
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(commandBuffer, range * sizeof(DrawCommand), sizeof(unsigned int), &count);
+    return count;
+}
+
+void SpriteArena::Draw(SpriteRange range) {
+    if (capacities[range] == 0) return;
+
+    // Shared by every range: the VAO bind is filtered after the first range drawn in a frame
+    GLState::BindVertexArray(vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glDrawArraysIndirect(GL_POINTS, (const void*)(range * sizeof(DrawCommand)));
+    GLState::CountDraw();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Sub-ranges of the arena, one per point-sprite population
+enum SpriteRange : unsigned int {
+    SPRITE_STARS = 0,        // First, so gas relayouts never move the stars
+    SPRITE_DARK_GAS,
+    SPRITE_LUMINOUS_GAS,
+    SPRITE_RANGE_COUNT
+};
+
+// One output buffer, one command buffer and one VAO shared by every point-sprite population.
+// Each range owns a slice of the output arena and one glDrawArraysIndirect command whose
+// `first` is the slice's offset; the cull shaders append to their range through
+// include/indirect_append.glsl (selected by the spriteRange uniform).
+//
+// The append compacts each workgroup before one global atomic reserves its block, through
+// subgroup ballot (GL_KHR_shader_subgroup_ballot) or a shared-memory counter. The subgroup
+// variant needs driver support and is chosen at startup when available; the workgroup
+// variant runs everywhere, including llvmpipe.
+//
+// Stars and gas render in different passes (program, blending, target), so each range is
+// still drawn on its own, but they share the buffers and the vertex format: the VAO and the
+// indirect buffer stay bound across passes and capacity is managed in one place.
+class SpriteArena {
+public:
+    enum class Compaction { Auto, Subgroup, Workgroup };
+
+    // Resolves Auto by querying subgroup ballot support in compute shaders. Needs a current
+    // context; call before the cull shaders are created
+    static void SelectCompaction(Compaction requested);
+    static Compaction ActiveCompaction();
+    // Defines selecting the variant of include/indirect_append.glsl
+    static std::vector<std::string> CullDefines();
+
+    // Sets the capacity (in sprites) of a range. Any change relays out the arena, which loses
+    // the contents of every range: callers compare LayoutVersion() before reusing a cull.
+    static void Reserve(SpriteRange range, size_t capacity);
+    static void Cleanup();
+
+    static unsigned int LayoutVersion();
+
+    // Zeroes the visible counts of ranges [first, first + count) on the GPU
+    static void ResetCounts(SpriteRange first, unsigned int count = 1);
+    // Output arena at storage binding 1, commands at binding 2 (indirect_append.glsl)
+    static void BindForCull();
+    // Draws one range with the bound program and render state
+    static void Draw(SpriteRange range);
+    // Visible count of a range after its last cull. Waits for the GPU (checks only)
+    static unsigned int ReadCount(SpriteRange range);
+
+    // Packed output sprite (SpriteRender in include/sprite_output.glsl)
+    static const size_t SPRITE_STRIDE = 12;
+};
@@ -1,6 +1,10 @@
 ﻿#include "Stars.h"
 #include "SolarSystem.h"
 #include "Shader.h"
+#include "GLState.h"
+#include "RenderInputs.h"
+#include "SpriteArena.h"
+#include "CullSlicer.h"
 #include "Window.h"
 #include "TextureGenerator.h"
 #include <glad/glad.h>
@@ -9,33 +13,47 @@
 #include <cmath>
 #include <random>
 #include <memory>
+#include <algorithm>
+#include <vector>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/packing.hpp>
-#include <fstream>
-#include <sstream>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 // GPU Resources
+// Culled stars go to the SPRITE_STARS range of the shared SpriteArena
 static unsigned int inputSSBO = 0;
-static unsigned int outputSSBO = 0;
-static unsigned int indirectBuffer = 0;
-static unsigned int starVAO = 0; // Empty VAO for drawing
-static unsigned int computeProgram = 0;
+static std::unique_ptr<Shader> starCullShader; // Compute
+static Uniform<int> starCullRange; // Resolved on the first cull (the program links in the startup batch)
 static std::unique_ptr<Shader> starRenderShader;
 static unsigned int starSpriteTexture = 0;
 
+// Unresolved stars (mapped brightness below FrameParams.starFluxThreshold, set by the quality
+// level) are accumulated by the cull into a half-resolution R32UI image (layers r, g, b) and
+// added in one full-screen pass, instead of each drawing a sprite of several pixels
+static std::unique_ptr<Shader> starFluxShader;
+static unsigned int starFluxTexture = 0;
+static glm::ivec2 starFluxSize = glm::ivec2(0); // Allocated size (half the render target capacity, only grows)
+static unsigned int starFluxVAO = 0; // Empty VAO for the full-screen triangle
+// Indirect draw of the flux pass; the cull sets its vertex count once a star reaches the image
+static unsigned int starFluxCommand = 0;
+
 // Capacity
 static size_t maxStars = 0;
+static RenderInputs starCullInputs; // Inputs the compacted stars in the arena were culled with
+static unsigned int starCullLayout = 0; // SpriteArena layout they were written to
+static bool starCullValid = false;
+static CullSlicer starCullSlicer; // Rejections reused between culls while only time advances
+
+// Rings per disk radius the star buffer is ordered by (generateStarField)
+static const float STAR_ORDER_RINGS = 128.0f;
 
-struct DrawCommand {
-    unsigned int count;
-    unsigned int instanceCount;
-    unsigned int first;
-    unsigned int baseInstance;
-};
+// Surface density of the galaxy (stars per unit^2 face-on) in rings out to the outermost star,
+// so the stochastic LOD only thins stars whose sprites overlap others (star_cull.comp)
+static const int STAR_DENSITY_RINGS = 128;
+static unsigned int densitySSBO = 0; // { ringWidth, density[STAR_DENSITY_RINGS] }
 
 // Star type colors
 namespace {
@@ -55,106 +73,69 @@ namespace {
     };
 }
 
-static void checkCompileErrors(unsigned int shader, std::string type) {
-    int success;
-    char infoLog[1024];
-    if (type != "PROGRAM") {
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            std::cerr << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-        }
-    }
-    else {
-        glGetProgramiv(shader, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-            std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-        }
-    }
-}
-
 void initStars() {
-    if (computeProgram != 0) cleanupStars();
+    if (starCullShader) cleanupStars();
 
     // 1. Compile Compute Shader
-    std::string code;
-    std::ifstream file("assets/shaders/star_cull.comp");
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Could not open assets/shaders/star_cull.comp" << std::endl;
+    try {
+        starCullShader = std::make_unique<Shader>("assets/shaders/star_cull.comp", SpriteArena::CullDefines());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
         return;
     }
-    std::stringstream ss;
-    ss << file.rdbuf();
-    code = ss.str();
-    const char* cCode = code.c_str();
-
-    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(shader, 1, &cCode, NULL);
-    glCompileShader(shader);
-    checkCompileErrors(shader, "COMPUTE");
-
-    computeProgram = glCreateProgram();
-    glAttachShader(computeProgram, shader);
-    glLinkProgram(computeProgram);
-    checkCompileErrors(computeProgram, "PROGRAM");
-    glDeleteShader(shader);
 
     // 2. Initialize Render Shader
+    // spriteTexture is fixed to unit 0 in the shader (no use() here, so batched compiles don't block)
     starRenderShader = std::make_unique<Shader>("assets/shaders/star.vert", "assets/shaders/star.frag");
-    starRenderShader->use();
-    starRenderShader->setInt("spriteTexture", 0);
+    starFluxShader = std::make_unique<Shader>("assets/shaders/post.vert", "assets/shaders/star_flux.frag", std::vector<std::string>{ "AT_FAR_PLANE" });
 
     // Generate Sprite Texture
     if (starSpriteTexture == 0) {
         starSpriteTexture = TextureGenerator::GenerateGlowSprite(128, 128);
     }
 
-    // 3. Create Buffers
+    // 3. Create Input Buffer
+    // Output, draw command and VAO are the SpriteArena's
     glGenBuffers(1, &inputSSBO);
-    glGenBuffers(1, &outputSSBO);
-    glGenBuffers(1, &indirectBuffer);
-
-    // Create empty VAO
-    glGenVertexArrays(1, &starVAO);
-    glBindVertexArray(starVAO);
+    glCreateBuffers(1, &densitySSBO);
+    glGenVertexArrays(1, &starFluxVAO);
 
-    // Bind Output Buffer as VBO for the VAO
-    glBindBuffer(GL_ARRAY_BUFFER, outputSSBO);
-
-    // Packed to 20 bytes (Pos(12) + Color(4) + Size(4))
-    const int STRIDE = 20;
-
-    // Attrib 0: Pos (vec3) - px, py, pz
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, STRIDE, (void*)0);
-
-    // Attrib 1: Color (vec4 unpacked from uint)
-    // Offset 12 (after 3 floats)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, STRIDE, (void*)12);
-
-    // Attrib 2: Size (float)
-    // Offset 16 (after color)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, STRIDE, (void*)16);
-
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // { count, instanceCount, first, baseInstance }; count is reset before every cull
+    const unsigned int fluxCommand[4] = { 0, 1, 0, 0 };
+    glCreateBuffers(1, &starFluxCommand);
+    glNamedBufferData(starFluxCommand, sizeof(fluxCommand), fluxCommand, GL_DYNAMIC_DRAW);
+}
 
-    // Setup Indirect Buffer
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
-    DrawCommand cmd = {0, 1, 0, 0};
-    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawCommand), &cmd, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+// Sized with the render target capacity, so resizes within it (window drags, render scale
+// steps) keep the image. Reallocation empties it, so the next frame culls again
+static void resizeStarFlux(const glm::ivec2& size) {
+    if (starFluxTexture) {
+        glDeleteTextures(1, &starFluxTexture);
+        // Deleting bound objects unbinds them behind the tracker's back
+        GLState::Reset();
+    }
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &starFluxTexture);
+    glTextureStorage3D(starFluxTexture, 1, GL_R32UI, size.x, size.y, 3);
+    // Integer textures are incomplete with linear filtering (star_flux.frag filters itself)
+    glTextureParameteri(starFluxTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(starFluxTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    starFluxSize = size;
+    starCullValid = false;
 }
 
 void cleanupStars() {
-    if (computeProgram) glDeleteProgram(computeProgram);
+    starCullShader.reset();
+    starCullRange = Uniform<int>();
+    starCullSlicer.Release();
     if (inputSSBO) glDeleteBuffers(1, &inputSSBO);
-    if (outputSSBO) glDeleteBuffers(1, &outputSSBO);
-    if (indirectBuffer) glDeleteBuffers(1, &indirectBuffer);
-    if (starVAO) glDeleteVertexArrays(1, &starVAO);
+    if (densitySSBO) glDeleteBuffers(1, &densitySSBO);
+    densitySSBO = 0;
+    if (starFluxTexture) glDeleteTextures(1, &starFluxTexture);
+    if (starFluxVAO) glDeleteVertexArrays(1, &starFluxVAO);
+    if (starFluxCommand) glDeleteBuffers(1, &starFluxCommand);
+    inputSSBO = starFluxTexture = starFluxVAO = starFluxCommand = 0;
+    starFluxSize = glm::ivec2(0);
+    starFluxShader.reset();
     if (starSpriteTexture) glDeleteTextures(1, &starSpriteTexture);
     starRenderShader.reset();
 }
@@ -162,72 +143,161 @@ void cleanupStars() {
 void uploadStarData(const std::vector<StarInput>& stars) {
     if (stars.empty()) return;
     maxStars = stars.size();
+    starCullValid = false;
 
     // 1. Upload Input Data (Static)
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, inputSSBO);
     glBufferData(GL_SHADER_STORAGE_BUFFER, stars.size() * sizeof(StarInput), stars.data(), GL_STATIC_DRAW);
 
-    // 2. Allocate Output Buffer (Dynamic - GPU write)
-    // Structure: 20 bytes per star (StarRender)
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, outputSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, stars.size() * 20, NULL, GL_DYNAMIC_DRAW);
-
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-}
 
-void renderStars(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time) {
-    if (!computeProgram || maxStars == 0) return;
+    // 2. Ring densities for the stochastic LOD
+    float maxRadius = 0.0f;
+    for (const StarInput& star : stars) maxRadius = std::max(maxRadius, star.radius);
+    float ringWidth = std::max(maxRadius, 1.0f) / STAR_DENSITY_RINGS;
 
-    // --- 1. COMPUTE PASS (CULLING) ---
-    glUseProgram(computeProgram);
+    std::vector<float> density(1 + STAR_DENSITY_RINGS, 0.0f);
+    density[0] = ringWidth;
+    for (const StarInput& star : stars) {
+        density[1 + std::min((int)(star.radius / ringWidth), STAR_DENSITY_RINGS - 1)] += 1.0f;
+    }
+    for (int i = 0; i < STAR_DENSITY_RINGS; i++) {
+        float inner = i * ringWidth, outer = inner + ringWidth;
+        density[1 + i] /= (float)M_PI * (outer * outer - inner * inner);
+    }
+    glNamedBufferData(densitySSBO, density.size() * sizeof(float), density.data(), GL_STATIC_DRAW);
 
-    // Bind Buffers
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, inputSSBO);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, outputSSBO);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indirectBuffer);
+    // 3. Reserve Output (12 bytes per star (SpriteRender) in the sprite arena)
+    SpriteArena::Reserve(SPRITE_STARS, stars.size());
+    starCullSlicer.Reserve(stars.size());
+}
 
-    // Reset Indirect Count
-    DrawCommand resetCmd = {0, 1, 0, 0};
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
-    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawCommand), &resetCmd);
-    // Note: We bind to GL_DRAW_INDIRECT_BUFFER for update, but it's bound as SSBO binding 2 for compute
+void renderStars(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time,
+                 const glm::ivec2& targetSize) {
+    if (!starCullShader || maxStars == 0) return;
 
-    // Uniforms
-    // Use layout(binding) in shader for UBO, so no need to set view/proj manually if UBO is bound globally
-    // But we need to ensure UBO is bound to binding 0
-    // GlobalUniforms is likely bound to 0 in main.cpp
+    // Fully faded out (deep system zoom): skip culling and drawing
+    if (zone.starBrightnessFade <= 0.0) return;
 
-    glUniform1f(glGetUniformLocation(computeProgram, "screenHeight"), (float)HEIGHT);
-    // bulgeRadius not strictly needed for rendering anymore, logic moved to generation
+    // The cull and star_flux.frag use the active part, half of FrameParams.renderSize
+    glm::ivec2 fluxCapacity((targetSize.x + 1) / 2, (targetSize.y + 1) / 2);
+    if (fluxCapacity.x > starFluxSize.x || fluxCapacity.y > starFluxSize.y) {
+        resizeStarFlux(glm::max(fluxCapacity, starFluxSize));
+    }
+    glm::ivec2 fluxSize((g_renderInputs.renderSize.x + 1) / 2, (g_renderInputs.renderSize.y + 1) / 2);
 
-    // Dispatch
-    // 256 threads per group
-    glDispatchCompute((unsigned int)((maxStars + 255) / 256), 1, 1);
+    // --- 1. COMPUTE PASS (CULLING) ---
+    // Positions, visibility and the flux image depend on the camera, time and render size:
+    // while none changed, the compacted stars and the image from the last cull are still in place
+    if (!starCullValid || starCullLayout != SpriteArena::LayoutVersion() || g_renderInputs != starCullInputs) {
+        starCullShader->use();
+        if (starCullRange.program != starCullShader->ID) {
+            starCullRange = starCullShader->GetUniform<int>("spriteRange");
+            starCullRange.Set(SPRITE_STARS);
+        }
 
-    // Barrier: Wait for shader writes to finish before drawing
-    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+        // Bind Buffers
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, inputSSBO);
+        SpriteArena::BindForCull();
+        glBindImageTexture(0, starFluxTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, starFluxCommand);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, densitySSBO);
+
+        // While only time moved since the last cull, its rejections are reused in all but one slice
+        bool sliced = starCullValid && starCullLayout == SpriteArena::LayoutVersion() &&
+                      g_renderInputs.SameExceptTime(starCullInputs);
+        starCullSlicer.Bind(*starCullShader, sliced, starCullInputs.time >= 0.0 ? g_renderInputs.time - starCullInputs.time : 0.0);
+
+        // Reset Indirect Counts and the flux image (cleared on the GPU)
+        SpriteArena::ResetCounts(SPRITE_STARS);
+        glClearNamedBufferSubData(starFluxCommand, GL_R32UI, 0, sizeof(unsigned int), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glClearTexSubImage(starFluxTexture, 0, 0, 0, 0, fluxSize.x, fluxSize.y, 3, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+        // Uniforms
+        // View/projection come from GlobalUniforms (binding 0)
+        // bulgeRadius not strictly needed for rendering anymore, logic moved to generation
+
+        // Dispatch
+        // 256 threads per group
+        glDispatchCompute((unsigned int)((maxStars + 255) / 256), 1, 1);
+        GLState::CountDispatch();
+
+        // Barrier: Wait for shader writes to finish before drawing
+        // (and for the slicing bits before the next cull)
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT |
+                        GL_SHADER_STORAGE_BARRIER_BIT);
+
+        starCullInputs = g_renderInputs;
+        starCullLayout = SpriteArena::LayoutVersion();
+        starCullValid = true;
+    }
 
     // --- 2. RENDER PASS ---
-    starRenderShader->use();
-    starRenderShader->setFloat("screenHeight", (float)HEIGHT);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, starSpriteTexture);
-
-    glEnable(GL_PROGRAM_POINT_SIZE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    glDepthMask(GL_FALSE);
-
-    glBindVertexArray(starVAO);
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    starRenderShader->use(); // Brightness fade is part of FrameParams
+
+    GLState::BindTexture(0, starSpriteTexture);
+
+    GLState::Enable(GL_PROGRAM_POINT_SIZE);
+    GLState::Enable(GL_BLEND);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+    GLState::Enable(GL_DEPTH_TEST); // Occluded by the resolved opaque depth
+    GLState::DepthMask(GL_FALSE);
+
+    SpriteArena::Draw(SPRITE_STARS);
+
+    // --- 3. UNRESOLVED STARS ---
+    // Drawn at the far plane, so the opaque scene occludes them like the sprites.
+    // Indirect: 0 vertices (no fragment work) when the threshold left every star resolved
+    starFluxShader->use();
+    GLState::BindTexture(0, starFluxTexture);
+    GLState::BlendFunc(GL_ONE, GL_ONE);
+    GLState::BindVertexArray(starFluxVAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, starFluxCommand);
+    glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+    GLState::CountDraw();
+}
 
-    glDrawArraysIndirect(GL_POINTS, 0);
+double measureStarLight(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time,
+                        unsigned int& spriteCount) {
+    glm::ivec2 size = g_renderInputs.renderSize;
+
+    // 1. Float target: the additive sprites and flux are summed unclamped
+    unsigned int colorTexture, depthTexture, fbo;
+    glCreateTextures(GL_TEXTURE_2D, 1, &colorTexture);
+    glTextureStorage2D(colorTexture, 1, GL_RGBA32F, size.x, size.y);
+    glCreateTextures(GL_TEXTURE_2D, 1, &depthTexture);
+    glTextureStorage2D(depthTexture, 1, GL_DEPTH_COMPONENT32F, size.x, size.y);
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, colorTexture, 0);
+    glNamedFramebufferTexture(fbo, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+
+    const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const float clearDepth = 1.0f;
+    GLState::DepthMask(GL_TRUE); // Clears obey the mask, which the last star pass left off
+    glClearNamedFramebufferfv(fbo, GL_COLOR, 0, clearColor);
+    glClearNamedFramebufferfv(fbo, GL_DEPTH, 0, &clearDepth);
+
+    // 2. Star pass, culled again: FrameParams may differ from the last cull with the same inputs
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, size.x, size.y);
+    starCullValid = false;
+    renderStars(zone, view, projection, camPos, time, size);
+    spriteCount = SpriteArena::ReadCount(SPRITE_STARS);
+
+    // 3. Total light (r + g + b)
+    std::vector<float> pixels((size_t)size.x * size.y * 4);
+    glGetTextureImage(colorTexture, 0, GL_RGBA, GL_FLOAT, (GLsizei)(pixels.size() * sizeof(float)), pixels.data());
+    double light = 0.0;
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        light += (double)pixels[i] + pixels[i + 1] + pixels[i + 2];
+    }
 
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
-    glBindVertexArray(0);
-    glDepthMask(GL_TRUE);
-    glDisable(GL_BLEND);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteTextures(1, &depthTexture);
+    // Deleting bound objects unbinds them behind the tracker's back
+    GLState::Reset();
+    return light;
 }
 
 
@@ -248,6 +318,8 @@ void generateStarField(std::vector<StarInput>& stars, const GalaxyConfig& config
 
     stars.clear();
     stars.reserve(config.numStars);
+    std::vector<std::pair<float, float>> orbits; // (radius, angle) of each star, for the ordering below
+    orbits.reserve(config.numStars);
 
     for (int i = 0; i < config.numStars; i++) {
         StarInput star;
@@ -382,5 +454,24 @@ void generateStarField(std::vector<StarInput>& stars, const GalaxyConfig& config
         star.color = packColorStar(r, g, b, 1.0f);
 
         stars.push_back(star);
+        orbits.emplace_back(radius, angle);
+    }
+
+    // Order the buffer by orbit: rings of STAR_ORDER_RINGS per disk radius, each by angle.
+    // Stars in a ring rotate at nearly the same rate, so consecutive stars stay a compact
+    // patch of sky: the cull's SIMD groups take the same branches, and skip together when
+    // the cull is sliced (CullSlicer)
+    const float ringWidth = static_cast<float>(config.diskRadius) / STAR_ORDER_RINGS;
+    std::vector<std::pair<int, float>> keys(stars.size());
+    std::vector<uint32_t> order(stars.size());
+    for (size_t i = 0; i < stars.size(); i++) {
+        keys[i] = { static_cast<int>(orbits[i].first / ringWidth), orbits[i].second };
+        order[i] = static_cast<uint32_t>(i);
     }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    std::vector<StarInput> ordered;
+    ordered.reserve(stars.size());
+    for (uint32_t i : order) ordered.push_back(stars[i]);
+    stars.swap(ordered);
 }
@@ -33,4 +33,12 @@ void initStars();
 void cleanupStars();
 void generateStarField(std::vector<StarInput>& stars, const GalaxyConfig& config);
 void uploadStarData(const std::vector<StarInput>& stars);
-void renderStars(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time);
+// targetSize: allocated size of the render targets, which the flux image follows (grow only)
+void renderStars(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time,
+                 const glm::ivec2& targetSize);
+// Renders the star pass alone (sprites and unresolved flux) into a float target of
+// g_renderInputs.renderSize and returns its total light (r + g + b), and the number of sprites
+// drawn in spriteCount. GlobalUniforms and FrameParams must be set for the view. Used by the
+// stochastic LOD check (--check-star-lod)
+double measureStarLight(const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& camPos, float time,
+                        unsigned int& spriteCount);
@@ -1,76 +1,64 @@
 #include "TextureGenerator.h"
+#include "Shader.h"
 #include <glad/glad.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <memory>
 #include <vector>
 
 // Helper to manage the Compute Shader
-static unsigned int computeProgram = 0;
+static std::unique_ptr<Shader> textureGenShader;
+static bool textureGenInitAttempted = false;
 
-static void InitComputeShader() {
-    if (computeProgram != 0) return;
-
-    std::string code;
-    std::ifstream file("assets/shaders/texture_gen.comp");
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Could not open assets/shaders/texture_gen.comp" << std::endl;
-        return;
-    }
-    std::stringstream ss;
-    ss << file.rdbuf();
-    code = ss.str();
-    const char* cCode = code.c_str();
-
-    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(shader, 1, &cCode, NULL);
-    glCompileShader(shader);
-
-    int success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[1024];
-        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
-        return;
-    }
+static struct {
+    Uniform<int> mode, width, height, octaves, seed;
+    Uniform<float> scale, persistence, waterLevel;
+    Uniform<glm::vec3> color1, color2;
+} genUniforms;
 
-    computeProgram = glCreateProgram();
-    glAttachShader(computeProgram, shader);
-    glLinkProgram(computeProgram);
-
-    glGetProgramiv(computeProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[1024];
-        glGetProgramInfoLog(computeProgram, 1024, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        return;
+static void InitComputeShader() {
+    if (textureGenInitAttempted) return;
+    textureGenInitAttempted = true;
+
+    try {
+        textureGenShader = std::make_unique<Shader>("assets/shaders/texture_gen.comp");
+
+        const Shader& s = *textureGenShader;
+        genUniforms.mode = s.GetUniform<int>("mode");
+        genUniforms.width = s.GetUniform<int>("width");
+        genUniforms.height = s.GetUniform<int>("height");
+        genUniforms.octaves = s.GetUniform<int>("octaves");
+        genUniforms.seed = s.GetUniform<int>("seed");
+        genUniforms.scale = s.GetUniform<float>("scale");
+        genUniforms.persistence = s.GetUniform<float>("persistence");
+        genUniforms.waterLevel = s.GetUniform<float>("waterLevel");
+        genUniforms.color1 = s.GetUniform<glm::vec3>("color1");
+        genUniforms.color2 = s.GetUniform<glm::vec3>("color2");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
     }
-
-    glDeleteShader(shader);
 }
 
 static void DispatchGen(unsigned int textureID, int width, int height, int mode, float scale, int octaves, float persistence, int seed, float waterLevel = 0.0f, float r1=0, float g1=0, float b1=0, float r2=0, float g2=0, float b2=0) {
     InitComputeShader();
-    if (computeProgram == 0) return;
+    if (!textureGenShader) return;
 
-    glUseProgram(computeProgram);
+    textureGenShader->use();
 
     // Bind image
     glBindImageTexture(0, textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
 
-    glUniform1i(glGetUniformLocation(computeProgram, "mode"), mode);
-    glUniform1i(glGetUniformLocation(computeProgram, "width"), width);
-    glUniform1i(glGetUniformLocation(computeProgram, "height"), height);
-    glUniform1f(glGetUniformLocation(computeProgram, "scale"), scale);
-    glUniform1i(glGetUniformLocation(computeProgram, "octaves"), octaves);
-    glUniform1f(glGetUniformLocation(computeProgram, "persistence"), persistence);
-    glUniform1i(glGetUniformLocation(computeProgram, "seed"), seed);
+    genUniforms.mode.Set(mode);
+    genUniforms.width.Set(width);
+    genUniforms.height.Set(height);
+    genUniforms.scale.Set(scale);
+    genUniforms.octaves.Set(octaves);
+    genUniforms.persistence.Set(persistence);
+    genUniforms.seed.Set(seed);
 
     if (mode == 1) {
-        glUniform1f(glGetUniformLocation(computeProgram, "waterLevel"), waterLevel);
-        glUniform3f(glGetUniformLocation(computeProgram, "color1"), r1, g1, b1);
-        glUniform3f(glGetUniformLocation(computeProgram, "color2"), r2, g2, b2);
+        genUniforms.waterLevel.Set(waterLevel);
+        genUniforms.color1.Set(glm::vec3(r1, g1, b1));
+        genUniforms.color2.Set(glm::vec3(r2, g2, b2));
     }
 
     // Dispatch
@@ -120,10 +108,8 @@ unsigned int TextureGenerator::GenerateGlowSprite(int width, int height) {
 }
 
 void TextureGenerator::Cleanup() {
-    if (computeProgram != 0) {
-        glDeleteProgram(computeProgram);
-        computeProgram = 0;
-    }
+    textureGenShader.reset();
+    textureGenInitAttempted = false;
 }
 
 unsigned int TextureGenerator::GeneratePlanetTexture(int width, int height, unsigned int seed, float waterLevel, float r1, float g1, float b1, float r2, float g2, float b2) {
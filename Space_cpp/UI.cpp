@@ -7,16 +7,21 @@
 #include "Input.h"
 #include "FontRenderer.h"
 #include "Shader.h"
+#include "FrameRing.h"
+#include "GLState.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <sstream>
 #include <cmath>
-#include <iomanip>
+#include <cstdio>
+#include <cstddef>
 #include <algorithm>
 #include <cctype>
 #include <vector>
+#include <cstring>
 #include <memory>
+#include <tuple>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -31,11 +36,29 @@ float g_currentTimeSpeed = 1.0f;
 
 // UI Render State
 static std::unique_ptr<Shader> uiBatchShader;
+static Uniform<glm::mat4> uiProjectionUniform;
 static unsigned int uiVAO = 0;
 static unsigned int uiVBO = 0;
 static glm::mat4 uiProjection;
 
-// The Batch Buffer
+// Retained geometry: the panel and the top-right overlay are rebuilt only when their inputs
+// change, and only a rebuilt section is uploaded into its range of uiVBO
+enum UISection {
+	UI_SECTION_PANEL,
+	UI_SECTION_OVERLAY,
+	UI_SECTION_COUNT
+};
+
+struct UISectionBuffer {
+	std::vector<UIVertex> vertices;
+	GLint first = 0;      // Range in uiVBO, in vertices
+	GLsizei capacity = 0;
+	bool dirty = true;
+};
+
+static UISectionBuffer uiSections[UI_SECTION_COUNT];
+
+// The draw helpers append here while a section is rebuilt
 static std::vector<UIVertex> uiBatchBuffer;
 
 enum ButtonID {
@@ -85,39 +108,75 @@ struct ButtonRect {
 static std::vector<ButtonRect> buttons;
 static double mouseX = 0, mouseY = 0;
 
+// Everything the panel geometry depends on
+struct PanelInputs {
+	int screenWidth = -1, screenHeight = -1;
+	int hoveredButton = BTN_NONE;
+	unsigned int seed = 0;
+	int starCount = 0;
+	int molecularClouds = 0, coldNeutralClouds = 0, warmNeutralClouds = 0;
+	int warmIonizedClouds = 0, hotIonizedClouds = 0, coronalClouds = 0;
+	bool turbulence = false, densityWaves = false, supermassive = false;
+	float blackHoleMass = 0.0f, solarSystemScale = 0.0f, timeSpeed = 0.0f;
+
+	auto key() const {
+		return std::tie(screenWidth, screenHeight, hoveredButton, seed, starCount,
+			molecularClouds, coldNeutralClouds, warmNeutralClouds, warmIonizedClouds, hotIonizedClouds, coronalClouds,
+			turbulence, densityWaves, supermassive, blackHoleMass, solarSystemScale, timeSpeed);
+	}
+};
+
+// The FPS counter and renderer stats (top right)
+struct OverlayInputs {
+	int screenWidth = -1;
+	int fps = -1;
+	const char* qualityName = nullptr;
+	int sceneGpuTenthsMs = -1;
+	GLState::Counters stats;
+
+	auto key() const {
+		return std::tie(screenWidth, fps, qualityName, sceneGpuTenthsMs, stats.drawCalls, stats.dispatches, stats.programSwitches,
+			stats.framebufferBinds, stats.stateChanges, stats.stateChangesFiltered);
+	}
+};
+
+static PanelInputs lastPanelInputs;
+static OverlayInputs lastOverlayInputs;
+
 void initUI() {
 	FontRenderer::initFont(1280, 720); // Default size
 
     uiBatchShader = std::make_unique<Shader>("assets/shaders/ui_batch.vert", "assets/shaders/ui_batch.frag");
+    uiBatchShader->GetUniform<int>("textTexture").Set(0);
+    uiProjectionUniform = uiBatchShader->GetUniform<glm::mat4>("projection");
 
     glGenVertexArrays(1, &uiVAO);
-    glGenBuffers(1, &uiVBO);
-
     glBindVertexArray(uiVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
 
-    // Layout matches UIVertex: x, y, u, v, r, g, b, a, mode
-    // 9 floats total
-    size_t stride = 9 * sizeof(float);
+    // Layout matches UIVertex (16 bytes), all read from vertex buffer binding 0.
+    // uiVBO is attached once the first build knows how large it has to be.
 
-    // 0: Pos (vec2)
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    // 0: Pos (int16 pixels)
+    glVertexAttribFormat(0, 2, GL_SHORT, GL_FALSE, offsetof(UIVertex, x));
+    glVertexAttribBinding(0, 0);
     glEnableVertexAttribArray(0);
 
-    // 1: UV (vec2)
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
+    // 1: UV (unorm16)
+    glVertexAttribFormat(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(UIVertex, u));
+    glVertexAttribBinding(1, 0);
     glEnableVertexAttribArray(1);
 
-    // 2: Color (vec4)
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+    // 2: Color (RGBA8)
+    glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(UIVertex, r));
+    glVertexAttribBinding(2, 0);
     glEnableVertexAttribArray(2);
 
-    // 3: Mode (float)
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+    // 3: Mode (integer)
+    glVertexAttribIFormat(3, 1, GL_UNSIGNED_BYTE, offsetof(UIVertex, mode));
+    glVertexAttribBinding(3, 0);
     glEnableVertexAttribArray(3);
 
     glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void cleanupUI() {
@@ -126,40 +185,97 @@ void cleanupUI() {
     uiBatchShader.reset();
 }
 
-// Draw Call Flush
-static void flushUIBatch() {
-    if (uiBatchBuffer.empty()) return;
+// Moves the rebuilt geometry from uiBatchBuffer into a section (swapping keeps both allocations)
+static void finishSection(UISection id) {
+    UISectionBuffer& section = uiSections[id];
+    section.vertices.swap(uiBatchBuffer);
+    uiBatchBuffer.clear();
+    section.dirty = true;
+}
 
-    uiBatchShader->use();
-    uiBatchShader->setMat4("projection", glm::value_ptr(uiProjection));
-    uiBatchShader->setInt("textTexture", 0);
+// Uploads the rebuilt sections; reallocates uiVBO when one outgrows its range
+static void uploadUISections() {
+    bool grow = false;
+    for (const UISectionBuffer& section : uiSections) {
+        if ((GLsizei)section.vertices.size() > section.capacity) grow = true;
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, FontRenderer::getFontTexture());
+    if (grow) {
+        // Headroom for longer numbers without reallocating again
+        GLint first = 0;
+        for (UISectionBuffer& section : uiSections) {
+            section.capacity = std::max((GLsizei)256, (GLsizei)(section.vertices.size() * 3 / 2));
+            section.first = first;
+            section.dirty = true;
+            first += section.capacity;
+        }
+        if (uiVBO) glDeleteBuffers(1, &uiVBO);
+        glCreateBuffers(1, &uiVBO);
+        glNamedBufferStorage(uiVBO, first * sizeof(UIVertex), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glVertexArrayVertexBuffer(uiVAO, 0, uiVBO, 0, sizeof(UIVertex));
+    }
 
-    glBindVertexArray(uiVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
-    glBufferData(GL_ARRAY_BUFFER, uiBatchBuffer.size() * sizeof(UIVertex), uiBatchBuffer.data(), GL_DYNAMIC_DRAW);
+    for (UISectionBuffer& section : uiSections) {
+        if (!section.dirty) continue;
+        // Copied from the frame ring on the GPU, ordered after the draws still reading the old range
+        if (!section.vertices.empty()) {
+            uploadFrameData(uiVBO, section.first * sizeof(UIVertex), section.vertices.data(),
+                            section.vertices.size() * sizeof(UIVertex));
+        }
+        section.dirty = false;
+    }
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)uiBatchBuffer.size());
+// Draw Call Flush: all sections in one call
+static void drawUISections() {
+    GLint firsts[UI_SECTION_COUNT];
+    GLsizei counts[UI_SECTION_COUNT];
+    GLsizei drawCount = 0;
+    for (const UISectionBuffer& section : uiSections) {
+        if (section.vertices.empty()) continue;
+        firsts[drawCount] = section.first;
+        counts[drawCount] = (GLsizei)section.vertices.size();
+        drawCount++;
+    }
+    if (drawCount == 0) return;
 
-    glBindVertexArray(0);
-    uiBatchBuffer.clear();
+    uiBatchShader->use();
+    uiProjectionUniform.Set(uiProjection);
+
+    GLState::BindTexture(0, FontRenderer::getFontTexture());
+    GLState::BindVertexArray(uiVAO);
+
+    glMultiDrawArrays(GL_TRIANGLES, firsts, counts, drawCount);
+    GLState::CountDraw();
+}
+
+static int hitTestButtons() {
+	for (const auto& btn : buttons) {
+		if (mouseX >= btn.x && mouseX <= btn.x + btn.width &&
+			mouseY >= btn.y && mouseY <= btn.y + btn.height) {
+			return btn.id;
+		}
+	}
+	return BTN_NONE;
 }
 
 static void drawRect(float x, float y, float width, float height,
 	float r, float g, float b, float a = 1.0f, bool filled = true) {
 
-    // Mode 1.0 = Rect
     if (filled) {
+        UIVertex v00 = packUIVertex(x, y, 0, 0, r, g, b, a, UI_MODE_RECT);
+        UIVertex v01 = packUIVertex(x, y + height, 0, 0, r, g, b, a, UI_MODE_RECT);
+        UIVertex v11 = packUIVertex(x + width, y + height, 0, 0, r, g, b, a, UI_MODE_RECT);
+        UIVertex v10 = packUIVertex(x + width, y, 0, 0, r, g, b, a, UI_MODE_RECT);
+
         // 2 Triangles
-        uiBatchBuffer.push_back({x, y, 0, 0, r, g, b, a, 1.0f});
-        uiBatchBuffer.push_back({x, y + height, 0, 0, r, g, b, a, 1.0f});
-        uiBatchBuffer.push_back({x + width, y + height, 0, 0, r, g, b, a, 1.0f});
+        uiBatchBuffer.push_back(v00);
+        uiBatchBuffer.push_back(v01);
+        uiBatchBuffer.push_back(v11);
 
-        uiBatchBuffer.push_back({x, y, 0, 0, r, g, b, a, 1.0f});
-        uiBatchBuffer.push_back({x + width, y + height, 0, 0, r, g, b, a, 1.0f});
-        uiBatchBuffer.push_back({x + width, y, 0, 0, r, g, b, a, 1.0f});
+        uiBatchBuffer.push_back(v00);
+        uiBatchBuffer.push_back(v11);
+        uiBatchBuffer.push_back(v10);
     } else {
         // Outline (4 thin filled rects)
         float t = 1.0f; // thickness
@@ -174,7 +290,7 @@ static void drawRect(float x, float y, float width, float height,
     }
 }
 
-static void drawButton(const std::string& label, float x, float y, float width, float height,
+static void drawButton(const char* label, float x, float y, float width, float height,
 	ButtonID id, bool hovered) {
 
 	if (hovered) {
@@ -250,7 +366,7 @@ void applyUIChangesToConfigs(const UIState& uiState, GalaxyConfig& galaxyConfig,
 	g_currentTimeSpeed = uiState.tempTimeSpeed;
 }
 
-static void drawNumberInput(const std::string& label, int value, float x, float y, float width,
+static void drawNumberInput(const char* label, int value, float x, float y, float width,
 	ButtonID incID, ButtonID decID, ButtonID resetID, bool hoveredInc, bool hoveredDec, bool hoveredReset) {
 	FontRenderer::appendText(label, x, y, 1.1f, 0.85f, 0.85f, 0.95f, 1.0f, uiBatchBuffer);
 
@@ -261,17 +377,17 @@ static void drawNumberInput(const std::string& label, int value, float x, float
 	drawRect(x, inputY, inputWidth, 30.0f, 0.08f, 0.08f, 0.1f, 0.95f);
 	drawRect(x, inputY, inputWidth, 30.0f, 0.4f, 0.45f, 0.5f, 0.8f, false);
 
-	std::stringstream ss;
-	ss << value;
+	char valueText[32];
+	snprintf(valueText, sizeof(valueText), "%d", value);
 
-    FontRenderer::appendText(ss.str(), x + 10, inputY + 7, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
+    FontRenderer::appendText(valueText, x + 10, inputY + 7, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
 
 	drawButton("-", x + inputWidth + 5, inputY, btnSize, 30.0f, decID, hoveredDec);
 	drawButton("+", x + inputWidth + btnSize + 10, inputY, btnSize, 30.0f, incID, hoveredInc);
 	drawButton("R", x + inputWidth + btnSize * 2 + 15, inputY, btnSize, 30.0f, resetID, hoveredReset);
 }
 
-static void drawFloatInput(const std::string& label, float value, float x, float y, float width,
+static void drawFloatInput(const char* label, float value, float x, float y, float width,
 	ButtonID incID, ButtonID decID, ButtonID resetID, bool hoveredInc, bool hoveredDec, bool hoveredReset) {
 
 	FontRenderer::appendText(label, x, y, 1.1f, 0.85f, 0.85f, 0.95f, 1.0f, uiBatchBuffer);
@@ -283,17 +399,17 @@ static void drawFloatInput(const std::string& label, float value, float x, float
 	drawRect(x, inputY, inputWidth, 30.0f, 0.08f, 0.08f, 0.1f, 0.95f);
 	drawRect(x, inputY, inputWidth, 30.0f, 0.4f, 0.45f, 0.5f, 0.8f, false);
 
-	std::stringstream ss;
-	ss << std::fixed << std::setprecision(1) << value;
+	char valueText[32];
+	snprintf(valueText, sizeof(valueText), "%.1f", value);
 
-    FontRenderer::appendText(ss.str(), x + 10, inputY + 7, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
+    FontRenderer::appendText(valueText, x + 10, inputY + 7, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
 
 	drawButton("-", x + inputWidth + 5, inputY, btnSize, 30.0f, decID, hoveredDec);
 	drawButton("+", x + inputWidth + btnSize + 10, inputY, btnSize, 30.0f, incID, hoveredInc);
 	drawButton("R", x + inputWidth + btnSize * 2 + 15, inputY, btnSize, 30.0f, resetID, hoveredReset);
 }
 
-static void drawToggle(const std::string& label, bool value, float x, float y,
+static void drawToggle(const char* label, bool value, float x, float y,
 	ButtonID toggleID, bool hovered) {
 	float boxSize = 24.0f;
 
@@ -314,22 +430,12 @@ static void drawToggle(const std::string& label, bool value, float x, float y,
 	buttons.push_back({ x, y, boxSize, boxSize, toggleID });
 }
 
-void renderUI(UIState& uiState, int screenWidth, int screenHeight) {
-	if (!uiState.isVisible) return;
-
-    // Ensure font init
-    FontRenderer::initFont(screenWidth, screenHeight);
-
-    // Update global projection
-    uiProjection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f);
-
+static void buildPanel(const UIState& uiState, int screenHeight) {
 	buttons.clear();
-    // Ensure buffer is cleared at start of frame
-    uiBatchBuffer.clear();
 
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	auto isHovered = [&uiState](ButtonID id) {
+		return uiState.hoveredButton == id;
+	};
 
 	float padding = 20.0f;
 	float panelWidth = 450.0f;
@@ -351,29 +457,17 @@ void renderUI(UIState& uiState, int screenWidth, int screenHeight) {
     FontRenderer::appendText("Galaxy Seed:", itemX, currentY, 1.1f, 0.85f, 0.85f, 0.95f, 1.0f, uiBatchBuffer);
 	currentY += 25.0f;
 
-	std::stringstream seedStr;
-	seedStr << uiState.currentSeed;
+	char seedStr[16];
+	snprintf(seedStr, sizeof(seedStr), "%u", uiState.currentSeed);
 
 	float seedBoxWidth = contentWidth - 85.0f;
 	drawRect(itemX, currentY, seedBoxWidth, 32.0f, 0.08f, 0.08f, 0.1f, 0.95f);
 	drawRect(itemX, currentY, seedBoxWidth, 32.0f, 0.4f, 0.45f, 0.5f, 0.8f, false);
-    FontRenderer::appendText(seedStr.str(), itemX + 10, currentY + 8, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
+    FontRenderer::appendText(seedStr, itemX + 10, currentY + 8, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f, uiBatchBuffer);
 
-	bool hoveredCopy = (mouseX >= itemX + seedBoxWidth + 10 && mouseX <= itemX + contentWidth &&
-		mouseY >= currentY && mouseY <= currentY + 32);
-	drawButton("Copy", itemX + seedBoxWidth + 10, currentY, 70.0f, 32.0f, BTN_COPY_SEED, hoveredCopy);
+	drawButton("Copy", itemX + seedBoxWidth + 10, currentY, 70.0f, 32.0f, BTN_COPY_SEED, isHovered(BTN_COPY_SEED));
 	currentY += 50.0f;
 
-	auto isHovered = [](ButtonID id) {
-		for (const auto& btn : buttons) {
-			if (btn.id == id && mouseX >= btn.x && mouseX <= btn.x + btn.width &&
-				mouseY >= btn.y && mouseY <= btn.y + btn.height) {
-				return true;
-			}
-		}
-		return false;
-		};
-
 	drawNumberInput("Star Count", uiState.tempStarCount, itemX, currentY, contentWidth,
 		BTN_STAR_INC, BTN_STAR_DEC, BTN_STAR_RESET,
 		isHovered(BTN_STAR_INC), isHovered(BTN_STAR_DEC), isHovered(BTN_STAR_RESET));
@@ -457,17 +551,94 @@ void renderUI(UIState& uiState, int screenWidth, int screenHeight) {
 
     FontRenderer::appendText("Press TAB to close | ESC to exit", itemX, currentY, 0.95f, 0.6f, 0.6f, 0.7f, 1.0f, uiBatchBuffer);
 
+    finishSection(UI_SECTION_PANEL);
+}
+
+static void buildOverlay(const OverlayInputs& overlay) {
 	// FPS Counter (Top Right)
-	std::stringstream fpsStream;
-	fpsStream << "FPS: " << static_cast<int>(uiState.fps);
-	std::string fpsStr = fpsStream.str();
+	char fpsStr[32];
+	snprintf(fpsStr, sizeof(fpsStr), "FPS: %d", overlay.fps);
 	float fpsWidth = FontRenderer::getTextWidth(fpsStr, 1.2f);
-    FontRenderer::appendText(fpsStr, screenWidth - fpsWidth - 20.0f, 20.0f, 1.2f, 0.0f, 1.0f, 0.0f, 1.0f, uiBatchBuffer);
+    FontRenderer::appendText(fpsStr, overlay.screenWidth - fpsWidth - 20.0f, 20.0f, 1.2f, 0.0f, 1.0f, 0.0f, 1.0f, uiBatchBuffer);
+
+    // Renderer stats of the previous frame (this frame's UI draw isn't counted yet)
+    const GLState::Counters& stats = overlay.stats;
+    char statsStr[128];
+    snprintf(statsStr, sizeof(statsStr), "%u draws | %u dispatches | %u programs | %u FBO binds",
+             stats.drawCalls, stats.dispatches, stats.programSwitches, stats.framebufferBinds);
+    float statsWidth = FontRenderer::getTextWidth(statsStr, 0.9f);
+    FontRenderer::appendText(statsStr, overlay.screenWidth - statsWidth - 20.0f, 50.0f, 0.9f, 0.6f, 0.8f, 0.6f, 1.0f, uiBatchBuffer);
+
+    snprintf(statsStr, sizeof(statsStr), "State changes: %u issued, %u filtered", stats.stateChanges, stats.stateChangesFiltered);
+    statsWidth = FontRenderer::getTextWidth(statsStr, 0.9f);
+    FontRenderer::appendText(statsStr, overlay.screenWidth - statsWidth - 20.0f, 72.0f, 0.9f, 0.6f, 0.8f, 0.6f, 1.0f, uiBatchBuffer);
+
+    if (overlay.qualityName) {
+        if (overlay.sceneGpuTenthsMs >= 0) {
+            snprintf(statsStr, sizeof(statsStr), "Quality: %s | scene %.1f ms GPU", overlay.qualityName, overlay.sceneGpuTenthsMs / 10.0f);
+        } else {
+            snprintf(statsStr, sizeof(statsStr), "Quality: %s", overlay.qualityName);
+        }
+        statsWidth = FontRenderer::getTextWidth(statsStr, 0.9f);
+        FontRenderer::appendText(statsStr, overlay.screenWidth - statsWidth - 20.0f, 94.0f, 0.9f, 0.6f, 0.8f, 0.6f, 1.0f, uiBatchBuffer);
+    }
+
+    finishSection(UI_SECTION_OVERLAY);
+}
+
+void renderUI(UIState& uiState, int screenWidth, int screenHeight) {
+	if (!uiState.isVisible) return;
+
+    // Ensure font init
+    FontRenderer::initFont(screenWidth, screenHeight);
+
+    // Hover is tested against the buttons of the last build; a change triggers a rebuild below
+    uiState.hoveredButton = hitTestButtons();
+
+    PanelInputs panel;
+    panel.screenWidth = screenWidth;
+    panel.screenHeight = screenHeight;
+    panel.hoveredButton = uiState.hoveredButton;
+    panel.seed = uiState.currentSeed;
+    panel.starCount = uiState.tempStarCount;
+    panel.molecularClouds = uiState.tempMolecularClouds;
+    panel.coldNeutralClouds = uiState.tempColdNeutralClouds;
+    panel.warmNeutralClouds = uiState.tempWarmNeutralClouds;
+    panel.warmIonizedClouds = uiState.tempWarmIonizedClouds;
+    panel.hotIonizedClouds = uiState.tempHotIonizedClouds;
+    panel.coronalClouds = uiState.tempCoronalClouds;
+    panel.turbulence = uiState.tempEnableTurbulence;
+    panel.densityWaves = uiState.tempEnableDensityWaves;
+    panel.supermassive = uiState.tempEnableSupermassive;
+    panel.blackHoleMass = uiState.tempBlackHoleMass;
+    panel.solarSystemScale = uiState.tempSolarSystemScale;
+    panel.timeSpeed = uiState.tempTimeSpeed;
+
+    if (panel.key() != lastPanelInputs.key()) {
+        // Update global projection
+        uiProjection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f);
+        buildPanel(uiState, screenHeight);
+        lastPanelInputs = panel;
+    }
+
+    OverlayInputs overlay;
+    overlay.screenWidth = screenWidth;
+    overlay.fps = static_cast<int>(uiState.fps);
+    overlay.qualityName = uiState.qualityName;
+    overlay.sceneGpuTenthsMs = uiState.sceneGpuMs < 0.0f ? -1 : static_cast<int>(uiState.sceneGpuMs * 10.0f);
+    overlay.stats = GLState::LastFrame();
+
+    if (overlay.key() != lastOverlayInputs.key()) {
+        buildOverlay(overlay);
+        lastOverlayInputs = overlay;
+    }
 
-    // FLUSH THE BATCH
-    flushUIBatch();
+	GLState::Disable(GL_DEPTH_TEST);
+	GLState::Enable(GL_BLEND);
+	GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_DEPTH_TEST);
+    uploadUISections();
+    drawUISections();
 }
 
 void handleUIInput(GLFWwindow* window, UIState& uiState, MouseState& mouseState) {
@@ -13,6 +13,8 @@ struct UIState {
     int activeInput;
 
     float fps;
+    const char* qualityName; // QualityGovernor level, refreshed with fps
+    float sceneGpuMs;        // Its smoothed scene GPU time (negative: not timed yet / disabled)
 
     int tempStarCount;
     int tempMolecularClouds;
@@ -45,6 +45,13 @@ GLFWwindow* initWindow(const WindowConfig& config) {
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return nullptr;
 	}
+	// Direct state access, glClearTexImage and glBufferStorage; glad leaves newer functions null
+	if (!GLAD_GL_VERSION_4_5) {
+		std::cerr << "OpenGL 4.5 is required, the context is " << glGetString(GL_VERSION) << std::endl;
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return nullptr;
+	}
 
 	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 	glViewport(0, 0, config.width, config.height);
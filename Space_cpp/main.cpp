@@ -3,6 +3,9 @@
 #include <iostream>
 #include <random>
 #include <memory>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 #include <glm/glm.hpp>
 
 #include "Window.h"
@@ -17,15 +20,30 @@
 #include "TextureGenerator.h"
 #include "Shader.h"
 #include "GlobalUniforms.h"
+#include "FrameRing.h"
+#include "GLState.h"
+#include "Headless.h"
+#include "Options.h"
+#include "FrameCapture.h"
+#include "ProgramCache.h"
+#include "ShaderLibrary.h"
+#include "RenderInputs.h"
+#include "SpriteArena.h"
+#include "QualityGovernor.h"
+#include "CullSlicer.h"
+#include "FramePacer.h"
 
 int WIDTH = 1280;
 int HEIGHT = 720;
 
 // Render Resources
 std::unique_ptr<GlobalUniformBuffer> globalUniforms;
+std::unique_ptr<FrameParamsBuffer> frameParams;
 std::unique_ptr<PostProcessor> postProcessor;
-std::unique_ptr<Shader> planetShader;
-std::unique_ptr<Shader> sunShader;
+std::unique_ptr<FrameCapture> frameCapture;
+std::unique_ptr<QualityGovernor> qualityGovernor;
+std::unique_ptr<Shader> bodyShader; // Sun and planets
+std::unique_ptr<Shader> bodyImpostorShader; // Sun and planets a few pixels across
 std::unique_ptr<Shader> blackHoleShader;
 std::unique_ptr<Shader> gasShader;
 std::unique_ptr<Shader> gasLowResShader;
@@ -35,6 +53,11 @@ unsigned int sunTexture = 0;
 unsigned int planetTexture = 0;
 unsigned int noiseTexture = 0;
 
+RenderInputs g_renderInputs;
+static RenderInputs lastSceneInputs; // Inputs of the scene currently held by the PostProcessor
+static unsigned int sceneVersion = 0;
+static float fixedRenderScale = 0.0f; // --render-scale; 0 follows the quality level
+
 GalaxyConfig createDefaultGalaxyConfig() {
 	GalaxyConfig config;
 	config.numStars = 1000000;
@@ -64,36 +87,46 @@ BlackHoleConfig createDefaultBlackHoleConfig() {
 	return config;
 }
 
-void render(const std::vector<StarInput>& stars, const std::vector<BlackHole>& blackHoles,
-	const std::vector<GasVertex>& darkGas, const std::vector<GasVertex>& luminousGas,
-    const Camera& camera, UIState& uiState) {
-    if (!postProcessor) {
-        fprintf(stderr, "FATAL: postProcessor is NULL in render!\n");
-        return;
-    }
-
-    // 1. Render Opaque to MSAA Framebuffer
-    postProcessor->BeginRender();
-
-    glm::mat4 view, projection;
-	getCameraMatrices(camera, WIDTH, HEIGHT, solarSystem, view, projection);
+// Pass parameters of a frame at the given render size
+static FrameParamsData makeFrameParams(const RenderZone& zone, const QualitySettings& quality, const glm::vec2& renderSize) {
+    FrameParamsData params = {};
+    params.renderSize = renderSize;
+    params.zNear = 0.1f;
+    params.zFar = 20000.0f;
+    params.starBrightnessFade = (float)zone.starBrightnessFade;
+    params.gasPointScale = 200.0f;
+    params.starFluxThreshold = quality.StarFluxThreshold;
+    params.gasLodArea = quality.GasLodArea;
+    params.starLodBrightness = quality.StarLodBrightness;
+    return params;
+}
 
-	RenderZone zone = calculateRenderZone(camera);
+// Everything up to the tonemapped composite in the PostProcessor's output
+static void renderScene(const std::vector<BlackHole>& blackHoles,
+	const std::vector<GasVertex>& darkGas, const std::vector<GasVertex>& luminousGas,
+    const Camera& camera, const RenderZone& zone, const glm::mat4& view, const glm::mat4& projection, double time,
+    const QualitySettings& quality) {
+    // 1. Render Opaque to MSAA Framebuffer (single-sample Intermediate FBO at low quality levels)
+    // Skipped (straight to single-sample) when no sun/planet/orbit covers a pixel
+    postProcessor->BeginRender(zone.renderOpaque);
 
     // Update Global Uniforms (UBO)
     if (globalUniforms) {
-        globalUniforms->update(view, projection, glm::vec3(camera.posX, camera.posY, camera.posZ), (float)glfwGetTime());
+        globalUniforms->update(view, projection, glm::vec3(camera.posX, camera.posY, camera.posZ), (float)time);
+    }
+    if (frameParams) {
+        frameParams->update(makeFrameParams(zone, quality, glm::vec2((float)postProcessor->Width, (float)postProcessor->Height)));
     }
 
-	if (solarSystem.isGenerated) {
-		if (!sunShader) fprintf(stderr, "sunShader is NULL\n");
-		if (!planetShader) fprintf(stderr, "planetShader is NULL\n");
+	if (solarSystem.isGenerated && zone.renderOpaque) {
+		if (!bodyShader) fprintf(stderr, "bodyShader is NULL\n");
+		if (!bodyImpostorShader) fprintf(stderr, "bodyImpostorShader is NULL\n");
 		if (!orbitShader) fprintf(stderr, "orbitShader is NULL\n");
 
-		renderSolarSystem(zone, camera, sunTexture, planetTexture, sunShader.get(), planetShader.get(), orbitShader.get());
+		renderSolarSystem(zone, camera, sunTexture, planetTexture, bodyShader.get(), bodyImpostorShader.get(), orbitShader.get());
 	}
 
-    // 2. Resolve Opaque to Intermediate FBO & Create Depth Copy
+    // 2. Resolve Opaque to Intermediate FBO & Build Linear Depth (Full + Low Res)
     // This prepares the pipeline for Transparent rendering
     postProcessor->PerformOpaqueResolve();
 
@@ -103,67 +136,330 @@ void render(const std::vector<StarInput>& stars, const std::vector<BlackHole>& b
     // This is handled in the specific render functions, but global state sets the stage.
 
     // 3. Prepare & Cull Gas Particles (Compute Shader)
-    // Reads ResolvedDepthCopyTexture (Single Sample) for occlusion culling
-    prepareGalacticGas(darkGas, luminousGas, (float)glfwGetTime(), postProcessor->ResolvedDepthCopyTexture, (float)WIDTH, (float)HEIGHT, zone, view, projection);
+    // Reads LinearDepthTexture for occlusion culling
+    // Screen size comes from FrameParams (the active render size, which lags the window while a resize is debounced)
+    prepareGalacticGas(darkGas, luminousGas, (float)time, postProcessor->LinearDepthTexture, zone, view, projection);
 
     // 4. Render Dark Gas (Full Res, Occlusion)
-    // Reads ResolvedDepthCopyTexture for soft particles
-    drawDarkGas(gasShader.get(), view, projection, (float)glfwGetTime(), postProcessor->ResolvedDepthCopyTexture);
+    // Reads LinearDepthTexture for soft particles
+    drawDarkGas(gasShader.get(), view, projection, (float)time, postProcessor->LinearDepthTexture);
 
     // Transparent / Additive
     // Stars (Additive) - Rendered to Intermediate FBO
-	renderStars(zone, view, projection, glm::vec3(camera.posX, camera.posY, camera.posZ), (float)glfwGetTime());
+	renderStars(zone, view, projection, glm::vec3(camera.posX, camera.posY, camera.posZ), (float)time,
+	            glm::ivec2(postProcessor->CapacityWidth, postProcessor->CapacityHeight));
 
-    // 5. Luminous Gas Pass (Quarter Res)
-    // Downsamples ResolvedDepthCopyTexture to LowResDepthTexture
-    postProcessor->PrepareGasPass();
-    postProcessor->BeginGasPass(); // Switch to Quarter-Res FBO
+    // 5. Luminous Gas Pass (Low Res, 1/4 by default)
+    postProcessor->BeginGasPass(); // Switch to Low-Res FBO
 
     // Draw using the optimized Low-Res Shader
-    // Reads LowResDepthTexture (generated in PrepareGasPass) for soft particles
-    drawLuminousGas(gasLowResShader.get(), view, projection, (float)glfwGetTime(), postProcessor->LowResDepthTexture, true);
+    // Reads LowResDepthTexture (generated in PerformOpaqueResolve) for soft particles
+    drawLuminousGas(gasLowResShader.get(), view, projection, (float)time, postProcessor->LowResDepthTexture,
+                    1.0f / postProcessor->GetLowResFactor());
 
     postProcessor->EndGasPass(); // Composites back to Intermediate FBO
 
     // Black Holes (Blend) - Rendered to Intermediate FBO
-	renderBlackHoles(blackHoles, zone, camera, view, projection, noiseTexture, blackHoleShader.get());
+	renderBlackHoles(blackHoles, zone, camera, view, projection, noiseTexture, blackHoleShader.get(), (float)time);
 
     // 6. Post-Processing (Bloom, Tone Mapping) -> Screen
     // Reads Intermediate FBO
     postProcessor->EndRender();
+}
+
+// Returns false if the cached scene was reused (nothing in it changed since the last frame)
+bool render(const std::vector<StarInput>& stars, const std::vector<BlackHole>& blackHoles,
+	const std::vector<GasVertex>& darkGas, const std::vector<GasVertex>& luminousGas,
+    const Camera& camera, UIState& uiState, double time) {
+    if (!postProcessor) {
+        fprintf(stderr, "FATAL: postProcessor is NULL in render!\n");
+        return false;
+    }
+
+    // Per-frame uniforms, UI vertices and indirect resets go to this frame's ring slice
+    if (g_frameRing) g_frameRing->BeginFrame();
+    // Anything may have changed GL state between frames (resizes, regeneration)
+    GLState::BeginFrame();
+
+    glm::mat4 view, projection;
+	getCameraMatrices(camera, WIDTH, HEIGHT, solarSystem, view, projection);
+
+    // Quality level picked from the GPU timings of earlier frames
+    if (qualityGovernor) qualityGovernor->Update();
+    const QualitySettings& quality = qualityGovernor ? qualityGovernor->Settings()
+                                                     : QualityGovernor::LEVELS[QualityGovernor::DEFAULT_LEVEL];
+    postProcessor->SetQuality(quality.MSAA, quality.GasLowResFactor, quality.BloomMips);
+    postProcessor->SetRenderScale(fixedRenderScale > 0.0f ? fixedRenderScale : quality.RenderScale);
+
+	RenderZone zone = calculateRenderZone(camera, view, projection, (int)postProcessor->Height);
+
+    g_renderInputs.view = view;
+    g_renderInputs.projection = projection;
+    g_renderInputs.time = time;
+    g_renderInputs.renderSize = glm::ivec2(postProcessor->Width, postProcessor->Height);
+    g_renderInputs.sceneVersion = sceneVersion;
+    g_renderInputs.qualityLevel = qualityGovernor ? qualityGovernor->Level() : QualityGovernor::DEFAULT_LEVEL;
+
+    // Paused with a still camera: the scene and bloom images from the last frame are still
+    // valid, only the composite (output size, exposure) and the UI are redone. Passes inside
+    // renderScene keep their own partial caches (culling) when only some inputs changed.
+    bool sceneReused = postProcessor->HasScene() && g_renderInputs == lastSceneInputs;
+    if (sceneReused) {
+        postProcessor->Composite();
+    } else {
+        if (qualityGovernor) qualityGovernor->BeginScene();
+        renderScene(blackHoles, darkGas, luminousGas, camera, zone, view, projection, time, quality);
+        if (qualityGovernor) qualityGovernor->EndScene();
+        lastSceneInputs = g_renderInputs;
+    }
+
+    // Capture the tonemapped frame (before the UI) without waiting for the readback
+    if (frameCapture) {
+        frameCapture->Capture(postProcessor->OutputFBO, postProcessor->OutputTexture,
+                              postProcessor->OutputWidth, postProcessor->OutputHeight);
+    }
+    postProcessor->PresentOutput();
 
     // UI rendered on top of everything (Post-process result is just a quad)
  	renderUI(uiState, WIDTH, HEIGHT);
+
+    if (g_frameRing) g_frameRing->EndFrame();
+    GLState::EndFrame();
+    return !sceneReused;
 }
 
-int main() {
-	WindowConfig windowConfig = { WIDTH, HEIGHT, "untitled Galaxy sim" };
-	GLFWwindow* window = initWindow(windowConfig);
-	if (!window) {
+// Largest relative change of the star pass's total light allowed by the stochastic LOD
+static const double STAR_LOD_LIGHT_TOLERANCE = 0.02;
+
+// Stochastic star LOD check (--check-star-lod, run by ctest). Thinning only moves light from
+// dropped stars to the boosted survivors, so at every quality level that thins, the star pass
+// (sprites and unresolved flux) must emit the light it emits with thinning off. Checked at
+// the start view (overview) and from the same point at galaxy scale (close-up). At the
+// overview, where the disk is crowded, it must also draw fewer sprites.
+static bool runStarLodCheck(const Camera& overview) {
+    Camera closeUp = overview;
+    closeUp.zoom = closeUp.zoomLevel = 1.0;
+
+    const Camera* views[] = { &overview, &closeUp };
+    bool passed = true;
+    for (const Camera* camera : views) {
+        glm::mat4 view, projection;
+        getCameraMatrices(*camera, WIDTH, HEIGHT, solarSystem, view, projection);
+        RenderZone zone = calculateRenderZone(*camera, view, projection, HEIGHT);
+        glm::vec3 camPos((float)camera->posX, (float)camera->posY, (float)camera->posZ);
+
+        g_renderInputs.view = view;
+        g_renderInputs.projection = projection;
+        g_renderInputs.time = 0.0;
+        g_renderInputs.renderSize = glm::ivec2(WIDTH, HEIGHT);
+
+        for (const QualitySettings& quality : QualityGovernor::LEVELS) {
+            if (quality.StarLodBrightness <= 0.0f) continue;
+
+            // Same flux threshold both times: only the thinned stars differ
+            double light[2];
+            unsigned int sprites[2];
+            for (int thinned = 0; thinned < 2; thinned++) {
+                if (g_frameRing) g_frameRing->BeginFrame();
+                GLState::BeginFrame();
+
+                FrameParamsData params = makeFrameParams(zone, quality, glm::vec2((float)WIDTH, (float)HEIGHT));
+                if (!thinned) params.starLodBrightness = 0.0f;
+                globalUniforms->update(view, projection, camPos, 0.0f);
+                frameParams->update(params);
+                light[thinned] = measureStarLight(zone, view, projection, camPos, 0.0f, sprites[thinned]);
+
+                if (g_frameRing) g_frameRing->EndFrame();
+                GLState::EndFrame();
+            }
+
+            // Nothing rendered counts as a failure, not as a match
+            double error = light[0] > 0.0 ? std::abs(light[1] - light[0]) / light[0] : 1.0;
+            bool ok = error <= STAR_LOD_LIGHT_TOLERANCE;
+            // Isolated stars are never thinned, so only the crowded overview must lose sprites
+            if (camera == &overview) ok = ok && sprites[1] < sprites[0];
+            std::cout << "StarLodCheck: " << (camera == &overview ? "overview" : "close-up") << ", " << quality.Name
+                      << " (LOD brightness " << quality.StarLodBrightness << "): " << light[1] << " vs " << light[0]
+                      << " unthinned (" << error * 100.0 << "%), " << sprites[1] << " vs " << sprites[0]
+                      << " sprites " << (ok ? "ok" : "FAILED") << std::endl;
+            passed = passed && ok;
+        }
+    }
+    return passed;
+}
+
+// Border strip compared by the render scale check (output pixels) and the largest difference
+// allowed in it (8-bit levels; additive sprites blend in cull order, which may change)
+static const int RENDER_SCALE_BORDER = 32;
+static const int RENDER_SCALE_TOLERANCE = 2;
+
+// Renders the scene at the given quality level and render scale and reads back the output (RGBA8)
+static std::vector<unsigned char> renderCheckFrame(const std::vector<BlackHole>& blackHoles,
+    const std::vector<GasVertex>& darkGas, const std::vector<GasVertex>& luminousGas,
+    const Camera& camera, int level, float renderScale) {
+    const QualitySettings& quality = QualityGovernor::LEVELS[level];
+    postProcessor->SetQuality(quality.MSAA, quality.GasLowResFactor, quality.BloomMips);
+    postProcessor->SetRenderScale(renderScale);
+
+    if (g_frameRing) g_frameRing->BeginFrame();
+    GLState::BeginFrame();
+
+    glm::mat4 view, projection;
+    getCameraMatrices(camera, WIDTH, HEIGHT, solarSystem, view, projection);
+    RenderZone zone = calculateRenderZone(camera, view, projection, (int)postProcessor->Height);
+
+    g_renderInputs.view = view;
+    g_renderInputs.projection = projection;
+    g_renderInputs.time = 0.0;
+    g_renderInputs.renderSize = glm::ivec2(postProcessor->Width, postProcessor->Height);
+    g_renderInputs.sceneVersion = sceneVersion;
+    g_renderInputs.qualityLevel = level;
+    renderScene(blackHoles, darkGas, luminousGas, camera, zone, view, projection, 0.0, quality);
+
+    std::vector<unsigned char> pixels((size_t)postProcessor->OutputWidth * postProcessor->OutputHeight * 4);
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, postProcessor->OutputFBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, postProcessor->OutputWidth, postProcessor->OutputHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    if (g_frameRing) g_frameRing->EndFrame();
+    GLState::EndFrame();
+    return pixels;
+}
+
+// Render scale check (--check-render-scale, a manual diagnostic: not registered with ctest). Stepping the render scale down
+// keeps the larger targets, whose pixels outside the new active size are stale. At every
+// quality level with a render scale below 1, the frame rendered right after a full-scale
+// frame must match, along the image borders, the frame rendered into zeroed targets.
+static bool runRenderScaleCheck(const std::vector<BlackHole>& blackHoles,
+    const std::vector<GasVertex>& darkGas, const std::vector<GasVertex>& luminousGas, const Camera& camera) {
+    bool passed = true;
+    for (int level = 0; level < QualityGovernor::LEVEL_COUNT; level++) {
+        float scale = QualityGovernor::LEVELS[level].RenderScale;
+        if (scale >= PostProcessor::MAX_RENDER_SCALE) continue;
+
+        // Full scale fills the targets, then the step down leaves the old frame around the active size
+        renderCheckFrame(blackHoles, darkGas, luminousGas, camera, level, PostProcessor::MAX_RENDER_SCALE);
+        std::vector<unsigned char> stepped = renderCheckFrame(blackHoles, darkGas, luminousGas, camera, level, scale);
+        postProcessor->ClearSceneTargets();
+        std::vector<unsigned char> reference = renderCheckFrame(blackHoles, darkGas, luminousGas, camera, level, scale);
+
+        int width = (int)postProcessor->OutputWidth;
+        int height = (int)postProcessor->OutputHeight;
+        int border = std::min(RENDER_SCALE_BORDER, std::min(width, height) / 2);
+        int maxDiff = 0;
+        bool lit = false; // The reference border isn't all black (nothing to compare otherwise)
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                bool inBorder = x < border || y < border || x >= width - border || y >= height - border;
+                if (!inBorder) continue;
+                for (int c = 0; c < 3; c++) {
+                    size_t i = ((size_t)y * width + x) * 4 + c;
+                    maxDiff = std::max(maxDiff, std::abs((int)stepped[i] - (int)reference[i]));
+                    lit = lit || reference[i] != 0;
+                }
+            }
+        }
+
+        bool ok = lit && maxDiff <= RENDER_SCALE_TOLERANCE;
+        std::cout << "RenderScaleCheck: " << QualityGovernor::LEVELS[level].Name << " (render scale " << scale
+                  << "): largest border difference after stepping down " << maxDiff
+                  << (lit ? "" : ", border is black") << " " << (ok ? "ok" : "FAILED") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+
+int main(int argc, char** argv) {
+	LaunchOptions options;
+	if (!parseLaunchOptions(argc, argv, options)) {
 		return -1;
 	}
+	WIDTH = options.width;
+	HEIGHT = options.height;
+
+	GLFWwindow* window = nullptr;
+	if (options.headless) {
+		// No window: render into offscreen targets through a surfaceless context
+		if (!initHeadlessContext()) {
+			return -1;
+		}
+	} else {
+		WindowConfig windowConfig = { WIDTH, HEIGHT, "untitled Galaxy sim" };
+		window = initWindow(windowConfig);
+		if (!window) {
+			return -1;
+		}
+	}
 
 	setupOpenGL();
+	ShaderLibrary::Init();
+	SpriteArena::SelectCompaction(options.cullCompaction == "subgroup" ? SpriteArena::Compaction::Subgroup
+		: options.cullCompaction == "workgroup" ? SpriteArena::Compaction::Workgroup : SpriteArena::Compaction::Auto);
+	CullSlicer::SetSliceCount(options.cullSlices);
+	if (!options.shaderCacheDir.empty()) {
+		initProgramCache(options.shaderCacheDir);
+	}
+
+	// 1 MB per frame: the uniform blocks and indirect resets are tiny, the rest is UI vertices
+	try {
+		g_frameRing = std::make_unique<FrameRing>(1 << 20);
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl; // Per-frame data falls back to buffer updates
+	}
 
     // Initialize Resources
-    postProcessor = std::make_unique<PostProcessor>(WIDTH, HEIGHT);
+    fixedRenderScale = (float)options.renderScale;
+    postProcessor = std::make_unique<PostProcessor>(WIDTH, HEIGHT, fixedRenderScale > 0.0f ? fixedRenderScale : 1.0f);
+    if (options.headless) {
+        postProcessor->EnableOffscreenOutput();
+    }
+    qualityGovernor = std::make_unique<QualityGovernor>(options.resolveFrameBudget());
 
-    // Shaders
+    if (options.isCapturing()) {
+        // Streaming to stdout: keep the log out of the video stream
+        if (options.captureRawPath == "-" || options.captureY4MPath == "-") {
+            std::cout.rdbuf(std::cerr.rdbuf());
+        }
+
+        double frameRate = options.timestep > 0.0 ? 1.0 / options.timestep : 60.0;
+        try {
+            if (!options.captureDir.empty()) {
+                frameCapture = std::make_unique<FrameCapture>(FrameCapture::Format::PNG, options.captureDir);
+            } else if (!options.captureRawPath.empty()) {
+                frameCapture = std::make_unique<FrameCapture>(FrameCapture::Format::RawRGB, options.captureRawPath);
+            } else {
+                frameCapture = std::make_unique<FrameCapture>(FrameCapture::Format::Y4M, options.captureY4MPath, frameRate);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+
+        // GPU-side conversion samples the composite, so it needs the offscreen target
+        if (frameCapture->NeedsColorTexture() && !options.headless) {
+            postProcessor->EnableOffscreenOutput(true);
+        }
+    }
+
+    // Shaders (compiled as one batch, checked together)
     try {
+        ShaderLibrary::BeginBatch();
         initStars();
-        planetShader = std::make_unique<Shader>("assets/shaders/planet.vert", "assets/shaders/planet.frag");
-        sunShader = std::make_unique<Shader>("assets/shaders/sun.vert", "assets/shaders/sun.frag");
+        bodyShader = std::make_unique<Shader>("assets/shaders/body.vert", "assets/shaders/body.frag");
+        bodyImpostorShader = std::make_unique<Shader>("assets/shaders/body.vert", "assets/shaders/body.frag", std::vector<std::string>{ "IMPOSTOR" });
         blackHoleShader = std::make_unique<Shader>("assets/shaders/blackhole.vert", "assets/shaders/blackhole.frag");
         gasShader = std::make_unique<Shader>("assets/shaders/gas.vert", "assets/shaders/gas.frag");
-        gasLowResShader = std::make_unique<Shader>("assets/shaders/gas.vert", "assets/shaders/gas_lowres.frag");
+        gasLowResShader = std::make_unique<Shader>("assets/shaders/gas.vert", "assets/shaders/gas.frag", std::vector<std::string>{ "LOW_RES" });
         orbitShader = std::make_unique<Shader>("assets/shaders/orbit.vert", "assets/shaders/orbit.frag");
+        ShaderLibrary::EndBatch();
 
         // Initialize UBO
         globalUniforms = std::make_unique<GlobalUniformBuffer>();
+        frameParams = std::make_unique<FrameParamsBuffer>();
 
         // Bind Uniform Blocks
-        planetShader->setUniformBlock("GlobalUniforms", 0);
-        sunShader->setUniformBlock("GlobalUniforms", 0);
+        bodyShader->setUniformBlock("GlobalUniforms", 0);
+        bodyImpostorShader->setUniformBlock("GlobalUniforms", 0);
         blackHoleShader->setUniformBlock("GlobalUniforms", 0);
         gasShader->setUniformBlock("GlobalUniforms", 0);
         gasLowResShader->setUniformBlock("GlobalUniforms", 0);
@@ -218,14 +514,16 @@ int main() {
 
 	MouseState mouseState = { WIDTH / 2.0, HEIGHT / 2.0, true };
 
-	initInput(window, camera, mouseState);
+	if (!options.headless) {
+		initInput(window, camera, mouseState);
 
-	try {
-		std::cout << "Initializing UI..." << std::endl;
-		initUI();
-		std::cout << "UI Initialized." << std::endl;
-	} catch (const std::exception& e) {
-		std::cerr << "UI Initialization failed: " << e.what() << std::endl;
+		try {
+			std::cout << "Initializing UI..." << std::endl;
+			initUI();
+			std::cout << "UI Initialized." << std::endl;
+		} catch (const std::exception& e) {
+			std::cerr << "UI Initialization failed: " << e.what() << std::endl;
+		}
 	}
 	UIState uiState = {};
 	uiState.isVisible = false;
@@ -239,11 +537,71 @@ int main() {
 
 	setGlobalUIState(&uiState);
 
+	if (options.headless) {
+		int exitCode = 0;
+		if (options.checkStarLod) {
+			exitCode = runStarLodCheck(camera) ? 0 : 1;
+		} else if (options.checkRenderScale) {
+			exitCode = runRenderScaleCheck(blackHoles, darkGasVertices, luminousGasVertices, camera) ? 0 : 1;
+		} else {
+			// Fixed timestep: simulation time advances by the same step every frame regardless of
+			// how long the frame took, so runs are reproducible across machines.
+			std::cout << "Headless: Rendering " << options.frames << " frames at " << WIDTH << "x" << HEIGHT
+			          << " (timestep " << options.timestep << " s)" << std::endl;
+
+			std::vector<double> frameTimesMs;
+			frameTimesMs.reserve(options.frames);
+			double simulationTime = 0.0;
+			GLState::Counters stateTotals;
+
+			for (int frame = 0; frame < options.frames; frame++) {
+				auto frameStart = std::chrono::steady_clock::now();
+
+				double adjustedDeltaTime = options.timestep * g_currentTimeSpeed;
+				updateBlackHoles(blackHoles, adjustedDeltaTime);
+				updatePlanets(adjustedDeltaTime);
+
+				render(stars, blackHoles, darkGasVertices, luminousGasVertices, camera, uiState, simulationTime);
+				stateTotals += GLState::LastFrame();
+
+				// Wait for the GPU so the frame time covers the whole pipeline
+				glFinish();
+				frameTimesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+				simulationTime += adjustedDeltaTime;
+			}
+
+			printFrameTimingStats(frameTimesMs);
+			printStateStats(stateTotals, options.frames);
+			if (qualityGovernor->Enabled()) {
+				std::cout << "Final quality level: " << qualityGovernor->Settings().Name << std::endl;
+			}
+		}
+
+		// Release GL objects while the context is still current
+		frameCapture.reset(); // Flushes outstanding frames
+		cleanupStars();
+		SpriteArena::Cleanup();
+		qualityGovernor.reset();
+		postProcessor.reset();
+		globalUniforms.reset();
+		frameParams.reset();
+		g_frameRing.reset();
+		bodyShader.reset();
+		bodyImpostorShader.reset();
+		blackHoleShader.reset();
+		gasShader.reset();
+		gasLowResShader.reset();
+		orbitShader.reset();
+		cleanupHeadlessContext();
+		return exitCode;
+	}
+
     // Register resize callback
+    // Reallocation is debounced so dragging the window edge doesn't recreate the targets every event
     setResizeCallback([](int w, int h) {
         if (postProcessor) {
-            std::cout << "Resizing PostProcessor..." << std::endl;
-            postProcessor->Resize(w, h);
+            postProcessor->RequestResize(w, h, glfwGetTime());
         }
     });
 
@@ -257,21 +615,38 @@ int main() {
 		return -1;
 	}
 
+	// While capturing, the simulation steps by the fixed timestep like the headless path so the
+	// recording doesn't depend on how fast frames are rendered (or how long the encoder blocks).
+	// Scaled by the time speed like the black holes and planets, so a paused simulation is
+	// a still frame on the GPU too.
+	double simulationTime = 0.0;
+	FramePacer framePacer(options.maxFps, options.backgroundFps);
+
 	while (!glfwWindowShouldClose(window)) {
+		// Minimized: nothing is rendered, and the simulation waits with it
+		if (!frameCapture && framePacer.WaitWhileHidden(window)) {
+			lastTime = glfwGetTime();
+			continue;
+		}
+
 		double currentTime = glfwGetTime();
 		double deltaTime = currentTime - lastTime;
 		lastTime = currentTime;
+		double simulationDelta = frameCapture ? options.timestep : deltaTime;
 
 		// FPS Calculation
 		frameCount++;
 		fpsTimer += deltaTime;
 		if (fpsTimer >= 1.0) {
 			uiState.fps = static_cast<float>(frameCount) / static_cast<float>(fpsTimer);
+			uiState.qualityName = qualityGovernor->Settings().Name;
+			uiState.sceneGpuMs = static_cast<float>(qualityGovernor->SmoothedGpuMs());
 			frameCount = 0;
 			fpsTimer = 0.0;
 		}
 
-		double adjustedDeltaTime = deltaTime * g_currentTimeSpeed;
+		double adjustedDeltaTime = simulationDelta * g_currentTimeSpeed;
+		simulationTime += adjustedDeltaTime;
 
 		// Star positions are now updated in the vertex shader
 		updateBlackHoles(blackHoles, adjustedDeltaTime);
@@ -296,20 +671,30 @@ int main() {
 			generateGalacticGas(darkGasVertices, luminousGasVertices, gasConfig, galaxyConfig.seed,
 				galaxyConfig.diskRadius, galaxyConfig.bulgeRadius);
 
+			sceneVersion++; // Re-uploads the gas and invalidates every cached pass
 			std::cout << "Galaxy regenerated with new parameters" << std::endl;
 			uiState.needsRegeneration = false;
 		}
 
 		processInput(window, camera, &uiState);
 
-		render(stars, blackHoles, darkGasVertices, luminousGasVertices, camera, uiState);
+		postProcessor->Update(currentTime);
+		bool sceneRendered = render(stars, blackHoles, darkGasVertices, luminousGasVertices, camera, uiState, simulationTime);
 
 		glfwSwapBuffers(window);
-		glfwPollEvents();
+		if (frameCapture) {
+			glfwPollEvents();
+		} else {
+			framePacer.EndFrame(window, !sceneRendered);
+		}
 	}
 
+	frameCapture.reset(); // Flushes outstanding frames
 	cleanupStars();
+	SpriteArena::Cleanup();
+	qualityGovernor.reset();
 	cleanupUI();
+	g_frameRing.reset();
     setResizeCallback(nullptr);
 	cleanup(window);
 	return 0;
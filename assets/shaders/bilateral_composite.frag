@@ -4,28 +4,23 @@ out vec4 FragColor;
 in vec2 TexCoords;
 
 uniform sampler2D gasTexture;          // Low-Res Color
-uniform sampler2D quarterResLinearDepth;  // Low-Res Depth (Linear)
-uniform sampler2D highResDepth;      // High-Res Depth (Single Sample Resolved)
+uniform sampler2D quarterResLinearDepth;  // Low-Res Depth (Linear Min/Max)
+uniform sampler2D highResDepth;      // High-Res Depth (Linear)
 
-uniform float zNear;
-uniform float zFar;
 uniform float depthSensitivity;
-
-float LinearizeDepth(float depth) {
-    float z = depth * 2.0 - 1.0;
-    return (2.0 * zNear * zFar) / (zFar + zNear - z * (zFar - zNear));
-}
+uniform float lowResScale; // Low-res pixels per full-res pixel (the gas pass's scale)
 
 void main()
 {
     // 1. Get High-Res Depth at current pixel
     ivec2 screenCoords = ivec2(gl_FragCoord.xy);
-    float dHigh = LinearizeDepth(texelFetch(highResDepth, screenCoords, 0).r);
+    float dHigh = texelFetch(highResDepth, screenCoords, 0).r;
 
     // 2. Bilateral Upsample
     // We look at the 4 nearest low-res pixels (bilinear neighborhood)
+    // The low-res targets are allocated for the finest scale: position from the pixel, not the UV
     ivec2 sizeLow = textureSize(gasTexture, 0);
-    vec2 posLow = TexCoords * vec2(sizeLow) - vec2(0.5);
+    vec2 posLow = gl_FragCoord.xy * lowResScale - vec2(0.5);
     ivec2 basePos = ivec2(floor(posLow));
     vec2 f = fract(posLow); // Fractional offset
 
@@ -44,8 +39,8 @@ void main()
         // Fetch Low-Res Color
         vec4 colorLow = texelFetch(gasTexture, p, 0);
 
-        // Fetch Low-Res Depth
-        float dLow = texelFetch(quarterResLinearDepth, p, 0).r;
+        // Fetch Low-Res Depth Range
+        vec2 dLow = texelFetch(quarterResLinearDepth, p, 0).rg;
 
         // Spatial Weight (Bilinear)
         float wSpatial = (i == 0) ? (1.0 - f.x) * (1.0 - f.y) :
@@ -53,8 +48,8 @@ void main()
                          (i == 2) ? (1.0 - f.x) * f.y :
                                     f.x * f.y;
 
-        // Depth Weight (Gaussian falloff based on depth difference)
-        float depthDiff = abs(dHigh - dLow);
+        // Depth Weight (Gaussian falloff based on distance to the block's depth range)
+        float depthDiff = max(dLow.x - dHigh, 0.0) + max(dHigh - dLow.y, 0.0);
         // Sensitive to depth scale.
         float wDepth = 1.0 / (1.0 + depthDiff * depthDiff * depthSensitivity);
 
@@ -68,6 +63,6 @@ void main()
         FragColor = totalColor / totalWeight;
     } else {
         // Fallback to bilinear if weights fail (e.g. extremely far depth diffs everywhere)
-        FragColor = texture(gasTexture, TexCoords);
+        FragColor = texture(gasTexture, (posLow + vec2(0.5)) / vec2(sizeLow));
     }
 }
@@ -9,11 +9,7 @@ uniform vec3 centerPos;
 uniform float innerRadius;
 uniform float outerRadius;
 
-layout (std140) uniform GlobalUniforms {
-    mat4 view;
-    mat4 projection;
-    vec4 viewPosTime;
-};
+#include "include/global_uniforms.glsl"
 
 void main()
 {
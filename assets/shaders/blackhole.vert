@@ -7,11 +7,7 @@ out vec3 FragPos;
 
 uniform mat4 model;
 
-layout (std140) uniform GlobalUniforms {
-    mat4 view;
-    mat4 projection;
-    vec4 viewPosTime;
-};
+#include "include/global_uniforms.glsl"
 
 void main()
 {
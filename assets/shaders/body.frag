@@ -0,0 +1,132 @@
+#version 430 core
+// Sun / planet shading for both body.vert variants (see there)
+out vec4 FragColor;
+
+#ifdef IMPOSTOR
+in vec3 RayTarget;
+flat in vec4 Sphere;
+
+// Surface point of the ray-traced sphere, filled in by traceSphere
+vec3 FragPos;
+vec3 Normal;
+vec2 TexCoords;
+#else
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+#endif
+flat in vec3 AtmosphereColor;
+flat in vec3 LightPos;
+flat in float IsSun;
+
+layout(binding = 0) uniform sampler2D planetTexture;
+layout(binding = 1) uniform sampler2D sunTexture;
+
+#include "include/global_uniforms.glsl"
+
+vec3 shadeSun(vec3 norm, vec3 viewDir)
+{
+    float time = viewPosTime.w;
+    // 1. Animated Surface
+    // Distort UVs with time
+    float speed = 0.05;
+    vec2 uv1 = TexCoords + vec2(time * speed, time * speed * 0.5);
+    vec2 uv2 = TexCoords - vec2(time * speed * 0.8, time * speed * 0.2);
+
+    vec3 col1 = texture(sunTexture, uv1).rgb;
+    vec3 col2 = texture(sunTexture, uv2).rgb;
+
+    // Blend them for turbulence
+    vec3 surfaceColor = mix(col1, col2, 0.5);
+
+    // Boost brightness for HDR bloom
+    surfaceColor *= 2.5;
+
+    // 2. Fresnel Glow (Corona)
+    float fresnel = 1.0 - max(dot(viewDir, norm), 0.0);
+    fresnel = pow(fresnel, 2.0);
+
+    vec3 coronaColor = vec3(1.0, 0.6, 0.2) * 4.0; // Super bright orange
+
+    return mix(surfaceColor, coronaColor, fresnel);
+}
+
+vec3 shadePlanet(vec3 norm, vec3 viewDir)
+{
+    // 1. Diffuse Lighting
+    vec3 lightDir = normalize(LightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+
+    // 2. Specular (Water Only - simplifed)
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+
+    vec4 texColor = texture(planetTexture, TexCoords);
+
+    // Assume Blue-ish pixels are water for specular mask
+    // Heuristic: Blue channel is significantly dominant over Red and Green
+    float blueDominance = 0.1; // Threshold for water detection
+    float isWater = step(texColor.r + blueDominance, texColor.b) * step(texColor.g + blueDominance, texColor.b);
+
+    float specularStrength = mix(0.0, 0.8, isWater); // 0.0 for land, 0.8 for water
+    vec3 specular = specularStrength * spec * vec3(1.0); // White specular highlight
+
+    // 3. Ambient
+    vec3 ambient = 0.05 * texColor.rgb; // Space is dark
+    vec3 diffuse = diff * texColor.rgb;
+
+    // 4. Rim Lighting (Atmosphere)
+    // Dot product of Normal and View Direction gives edge factor
+    float rimFactor = 1.0 - max(dot(viewDir, norm), 0.0);
+    rimFactor = pow(rimFactor, 4.0); // Sharp rim
+    vec3 rim = rimFactor * AtmosphereColor * 1.5;
+
+    // Atmosphere glows everywhere but brighter on the sun side
+    float sunFacing = max(dot(norm, lightDir), 0.0) * 0.5 + 0.5;
+    rim *= sunFacing;
+
+    return ambient + diffuse + specular + rim;
+}
+
+#ifdef IMPOSTOR
+const float PI = 3.14159265359;
+
+// Intersects the camera ray through this pixel with the sphere and writes the surface depth.
+// Works relative to the center so tiny bodies far from the camera keep their precision.
+void traceSphere()
+{
+    vec3 rayOrigin = viewPosTime.xyz;
+    vec3 rayDir = normalize(RayTarget - rayOrigin);
+    vec3 oc = rayOrigin - Sphere.xyz;
+    float b = dot(oc, rayDir);
+    vec3 perpendicular = oc - b * rayDir; // Center to the closest point on the ray
+    float h = Sphere.w * Sphere.w - dot(perpendicular, perpendicular);
+    if (h < 0.0) discard;
+    h = sqrt(h);
+
+    // Front hit: oc + t * rayDir with t = -b - h
+    vec3 surface = perpendicular - h * rayDir;
+    FragPos = Sphere.xyz + surface;
+    Normal = surface / Sphere.w;
+
+    // Same parameterization as the sphere mesh (x = cos(2 pi u) sin(pi v), y = cos(pi v))
+    float u = atan(Normal.z, Normal.x) / (2.0 * PI);
+    TexCoords = vec2(u < 0.0 ? u + 1.0 : u, acos(clamp(Normal.y, -1.0, 1.0)) / PI);
+
+    vec4 clipPos = projection * view * vec4(FragPos, 1.0);
+    gl_FragDepth = clipPos.z / clipPos.w * 0.5 + 0.5;
+}
+#endif
+
+void main()
+{
+#ifdef IMPOSTOR
+    traceSphere();
+#endif
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPosTime.xyz - FragPos);
+
+    // Uniform per instance, so the branch doesn't diverge within a body
+    vec3 result = IsSun > 0.5 ? shadeSun(norm, viewDir) : shadePlanet(norm, viewDir);
+    FragColor = vec4(result, 1.0);
+}
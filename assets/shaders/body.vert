@@ -0,0 +1,71 @@
+#version 430 core
+// Suns and planets, one instance per visible body. Compiled twice: sphere meshes (the LOD
+// levels share this program) and with IMPOSTOR defined for bodies only a few pixels across,
+// which are drawn as camera-facing quads and ray-traced in body.frag.
+
+// One instance per visible sun or planet (unit sphere scaled uniformly, so the normal needs no inverse transpose)
+struct BodyInstance {
+    vec4 positionRadius; // xyz: center, w: radius
+    vec4 colorKind;      // rgb: atmosphere color, w: 0 = planet, 1 = sun
+    vec4 lightPos;       // xyz: the star lighting this body
+};
+
+layout(std430, binding = 3) readonly buffer BodyInstances {
+    BodyInstance bodies[];
+};
+
+uniform int instanceOffset; // First instance of this draw's LOD bucket
+
+#ifdef IMPOSTOR
+out vec3 RayTarget;         // World-space point on the quad
+flat out vec4 Sphere;       // xyz: center, w: radius
+#else
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+#endif
+flat out vec3 AtmosphereColor;
+flat out vec3 LightPos;
+flat out float IsSun;
+
+#include "include/global_uniforms.glsl"
+
+void main()
+{
+    BodyInstance body = bodies[instanceOffset + gl_InstanceID];
+    vec3 center = body.positionRadius.xyz;
+    float radius = body.positionRadius.w;
+
+    AtmosphereColor = body.colorKind.rgb;
+    LightPos = body.lightPos.xyz;
+    IsSun = body.colorKind.w;
+
+#ifdef IMPOSTOR
+    // Quad through the center, perpendicular to the camera ray, sized to the silhouette:
+    // the tangent cone from the camera meets that plane in a circle of radius r * d / sqrt(d^2 - r^2)
+    vec3 toCenter = center - viewPosTime.xyz;
+    float dist = length(toCenter);
+    vec3 forward = toCenter / dist;
+    vec3 up = abs(forward.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 right = normalize(cross(forward, up));
+    up = cross(right, forward);
+    float extent = radius * dist / sqrt(max(dist * dist - radius * radius, 1e-12));
+
+    // Triangle strip corners from the vertex index: (-1,-1), (1,-1), (-1,1), (1,1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    RayTarget = center + (right * corner.x + up * corner.y) * extent;
+    Sphere = vec4(center, radius);
+
+    gl_Position = projection * view * vec4(RayTarget, 1.0);
+#else
+    FragPos = center + aPos * radius;
+    Normal = aNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+#endif
+}
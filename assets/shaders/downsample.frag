@@ -4,6 +4,13 @@ in vec2 TexCoords;
 
 uniform sampler2D srcTexture;
 uniform vec2 srcResolution;
+// Last texel center of the active region: the rest of the source holds stale pixels from a
+// larger frame (the targets are reused after shrinking)
+uniform vec2 maxUV;
+
+vec3 sampleSource(vec2 uv) {
+    return texture(srcTexture, min(uv, maxUV)).rgb;
+}
 
 void main()
 {
@@ -13,11 +20,11 @@ void main()
 
     // Simple 5-tap Downsample (Center + 4 corners)
     // This leverages hardware bilinear filtering for the samples in between
-    vec3 s0 = texture(srcTexture, TexCoords).rgb;
-    vec3 s1 = texture(srcTexture, TexCoords + vec2(2.0*x, 2.0*y)).rgb;
-    vec3 s2 = texture(srcTexture, TexCoords + vec2(-2.0*x, 2.0*y)).rgb;
-    vec3 s3 = texture(srcTexture, TexCoords + vec2(2.0*x, -2.0*y)).rgb;
-    vec3 s4 = texture(srcTexture, TexCoords + vec2(-2.0*x, -2.0*y)).rgb;
+    vec3 s0 = sampleSource(TexCoords);
+    vec3 s1 = sampleSource(TexCoords + vec2(2.0*x, 2.0*y));
+    vec3 s2 = sampleSource(TexCoords + vec2(-2.0*x, 2.0*y));
+    vec3 s3 = sampleSource(TexCoords + vec2(2.0*x, -2.0*y));
+    vec3 s4 = sampleSource(TexCoords + vec2(-2.0*x, -2.0*y));
 
     FragColor = vec4((s0*4.0 + s1 + s2 + s3 + s4) / 8.0, 1.0);
 }
@@ -0,0 +1,133 @@
+#version 330 core
+// Edge-adaptive spatial upscale (after AMD FidelityFX FSR1 EASU)
+// Scales the tonemapped, gamma-encoded composite from the render size to the output size.
+// Each output pixel filters the 12 nearest source pixels (4x4 without the corners) with a
+// Lanczos-2 approximation stretched along the local edge direction, then clamps to the
+// 2x2 neighborhood to avoid ringing.
+out vec4 FragColor;
+
+uniform sampler2D source;   // Composite at the render size (allocated with spare capacity)
+uniform vec2 sourceSize;    // Active render size (pixels)
+uniform vec2 outputSize;
+
+vec3 fetchSource(ivec2 p) {
+    return texelFetch(source, clamp(p, ivec2(0), ivec2(sourceSize) - 1), 0).rgb;
+}
+
+// Luma approximation used for the edge analysis
+float luma(vec3 c) {
+    return c.b * 0.5 + (c.r * 0.5 + c.g);
+}
+
+// Edge direction and length at one of the 4 inner pixels, weighted by its bilinear weight
+//     a
+//   b c d
+//     e
+void accumulateEdge(inout vec2 dir, inout float len, float w,
+                    float lA, float lB, float lC, float lD, float lE) {
+    float dc = lD - lC;
+    float cb = lC - lB;
+    float lenX = max(abs(dc), abs(cb));
+    lenX = lenX > 0.0 ? 1.0 / lenX : 0.0;
+    float dirX = lD - lB;
+    lenX = clamp(abs(dirX) * lenX, 0.0, 1.0);
+    lenX *= lenX;
+
+    float ec = lE - lC;
+    float ca = lC - lA;
+    float lenY = max(abs(ec), abs(ca));
+    lenY = lenY > 0.0 ? 1.0 / lenY : 0.0;
+    float dirY = lE - lA;
+    lenY = clamp(abs(dirY) * lenY, 0.0, 1.0);
+    lenY *= lenY;
+
+    dir += vec2(dirX, dirY) * w;
+    len += (lenX + lenY) * w;
+}
+
+// One tap of the stretched, rotated kernel
+void accumulateTap(inout vec3 color, inout float weight, vec2 offset, vec2 dir, vec2 len2,
+                   float lob, float clp, vec3 c) {
+    vec2 v = vec2(offset.x * dir.x + offset.y * dir.y,
+                  offset.x * -dir.y + offset.y * dir.x);
+    v *= len2;
+    float d2 = min(dot(v, v), clp);
+
+    // Lanczos-2 approximation: (25/16 * (2/5 * x^2 - 1)^2 - (25/16 - 1)) * (lob * x^2 - 1)^2
+    float wB = 2.0 / 5.0 * d2 - 1.0;
+    float wA = lob * d2 - 1.0;
+    wB *= wB;
+    wA *= wA;
+    wB = 25.0 / 16.0 * wB - (25.0 / 16.0 - 1.0);
+    float w = wB * wA;
+
+    color += c * w;
+    weight += w;
+}
+
+void main() {
+    // Output pixel center in source pixels, relative to the nearest source pixel center f
+    vec2 pp = gl_FragCoord.xy * (sourceSize / outputSize) - 0.5;
+    ivec2 fp = ivec2(floor(pp));
+    vec2 pf = pp - vec2(fp);
+
+    //      b c
+    //    e f g h
+    //    i j k l
+    //      n o
+    vec3 b = fetchSource(fp + ivec2(0, -1));
+    vec3 c = fetchSource(fp + ivec2(1, -1));
+    vec3 e = fetchSource(fp + ivec2(-1, 0));
+    vec3 f = fetchSource(fp);
+    vec3 g = fetchSource(fp + ivec2(1, 0));
+    vec3 h = fetchSource(fp + ivec2(2, 0));
+    vec3 i = fetchSource(fp + ivec2(-1, 1));
+    vec3 j = fetchSource(fp + ivec2(0, 1));
+    vec3 k = fetchSource(fp + ivec2(1, 1));
+    vec3 l = fetchSource(fp + ivec2(2, 1));
+    vec3 n = fetchSource(fp + ivec2(0, 2));
+    vec3 o = fetchSource(fp + ivec2(1, 2));
+
+    float bL = luma(b), cL = luma(c), eL = luma(e), fL = luma(f), gL = luma(g), hL = luma(h);
+    float iL = luma(i), jL = luma(j), kL = luma(k), lL = luma(l), nL = luma(n), oL = luma(o);
+
+    // 1. Edge direction and length, bilinearly blended from the 4 inner pixels
+    vec2 dir = vec2(0.0);
+    float len = 0.0;
+    accumulateEdge(dir, len, (1.0 - pf.x) * (1.0 - pf.y), bL, eL, fL, gL, jL);
+    accumulateEdge(dir, len, pf.x * (1.0 - pf.y), cL, fL, gL, hL, kL);
+    accumulateEdge(dir, len, (1.0 - pf.x) * pf.y, fL, iL, jL, kL, nL);
+    accumulateEdge(dir, len, pf.x * pf.y, gL, jL, kL, lL, oL);
+
+    float dirR = dot(dir, dir);
+    dir = dirR < 1.0 / 32768.0 ? vec2(1.0, 0.0) : dir * inversesqrt(dirR);
+
+    // 2. Kernel shape: stretched along the edge and sharper across it as the edge gets stronger
+    len = len * 0.5;
+    len *= len;
+    float stretch = dot(dir, dir) / max(abs(dir.x), abs(dir.y));
+    vec2 len2 = vec2(1.0 + (stretch - 1.0) * len, 1.0 - 0.5 * len);
+    float lob = 0.5 + (1.0 / 4.0 - 0.04 - 0.5) * len;
+    float clp = 1.0 / lob;
+
+    // 3. Filter
+    vec3 color = vec3(0.0);
+    float weight = 0.0;
+    accumulateTap(color, weight, vec2( 0.0, -1.0) - pf, dir, len2, lob, clp, b);
+    accumulateTap(color, weight, vec2( 1.0, -1.0) - pf, dir, len2, lob, clp, c);
+    accumulateTap(color, weight, vec2(-1.0,  1.0) - pf, dir, len2, lob, clp, i);
+    accumulateTap(color, weight, vec2( 0.0,  1.0) - pf, dir, len2, lob, clp, j);
+    accumulateTap(color, weight, vec2( 0.0,  0.0) - pf, dir, len2, lob, clp, f);
+    accumulateTap(color, weight, vec2(-1.0,  0.0) - pf, dir, len2, lob, clp, e);
+    accumulateTap(color, weight, vec2( 1.0,  1.0) - pf, dir, len2, lob, clp, k);
+    accumulateTap(color, weight, vec2( 2.0,  1.0) - pf, dir, len2, lob, clp, l);
+    accumulateTap(color, weight, vec2( 2.0,  0.0) - pf, dir, len2, lob, clp, h);
+    accumulateTap(color, weight, vec2( 1.0,  0.0) - pf, dir, len2, lob, clp, g);
+    accumulateTap(color, weight, vec2( 1.0,  2.0) - pf, dir, len2, lob, clp, o);
+    accumulateTap(color, weight, vec2( 0.0,  2.0) - pf, dir, len2, lob, clp, n);
+
+    // 4. Deringing: clamp to the 2x2 neighborhood
+    vec3 minColor = min(min(f, g), min(j, k));
+    vec3 maxColor = max(max(f, g), max(j, k));
+    FragColor = vec4(clamp(color / weight, minColor, maxColor), 1.0);
+}
@@ -1,14 +1,20 @@
 #version 330 core
+// Soft gas particles. Compiled twice: full-res (dark gas, luminous fallback) and with
+// LOW_RES defined for the low-res luminous pass.
 out vec4 FragColor;
 
 in vec4 Color;
 in float LinearDepth;
 
-uniform sampler2D depthMap; // Single-sampled Resolved Depth
-uniform float zNear;
-uniform float zFar;
+#ifdef LOW_RES
+// Low-Res Min/Max Linear Depth Texture (RG32F)
+// No MSAA overhead, no linearization math in pixel shader
+uniform sampler2D quarterResLinearDepth;
+#else
+uniform sampler2D depthMap; // Full-Res Linear Depth (R32F)
+uniform float resolutionScale; // Full-res pixels per target pixel (to scale gl_FragCoord)
+#endif
 uniform float softnessScale; // Controls how soft the intersection is (e.g. 1.0)
-uniform float resolutionScale; // 1.0 for full-res, 4.0 for quarter-res (to scale gl_FragCoord)
 
 void main()
 {
@@ -20,12 +26,13 @@ void main()
 
     // 2. Depth Buffer Softness (Intersection with geometry)
     // Use texelFetch for single-sample texture
+#ifdef LOW_RES
+    // Nearest depth in the block; gl_FragCoord is already in low-res space (0..w/f, 0..h/f)
+    float sceneDepthLinear = texelFetch(quarterResLinearDepth, ivec2(gl_FragCoord.xy), 0).r;
+#else
     ivec2 screenCoords = ivec2(gl_FragCoord.xy * resolutionScale);
-    float sceneDepthNonLinear = texelFetch(depthMap, screenCoords, 0).r;
-
-    // Optimized LinearizeDepth
-    // Derived from projection matrix linearization
-    float sceneDepthLinear = (zNear * zFar) / (zFar - sceneDepthNonLinear * (zFar - zNear));
+    float sceneDepthLinear = texelFetch(depthMap, screenCoords, 0).r;
+#endif
 
     // Calculate difference between scene geometry and this particle
     // If sceneDepth < LinearDepth (particle is behind geometry), depthDelta is negative
@@ -1,33 +1,31 @@
 #version 430 core
 
-// Inputs match the VAO layout defined in GalacticGas.cpp
-layout (location = 0) in vec3 aViewPos;    // From GasRender.px, py, pz
-layout (location = 1) in vec4 aColor;      // From GasRender.color (Unpacked from uint)
-layout (location = 2) in float aSize;      // From GasRender.size
+// Inputs match the VAO layout defined in SpriteArena.cpp
+layout (location = 0) in vec2 aNdc;        // From SpriteRender.ndcXY (unorm16)
+layout (location = 1) in vec4 aColor;      // From SpriteRender.color (Unpacked from uint)
+layout (location = 2) in uint aDepthSize;  // From SpriteRender.depthSize (view depth, size)
 
 out vec4 Color;
 out float LinearDepth;
 
-layout (std140) uniform GlobalUniforms {
-    mat4 view;
-    mat4 projection;
-    vec4 viewPosTime;
-};
+#include "include/global_uniforms.glsl"
+#include "include/frame_params.glsl"
+#include "include/sprite_output.glsl"
 
 uniform float pointMultiplier;
 
 void main()
 {
-    // The position is already in View Space (from Compute Shader)
-    gl_Position = projection * vec4(aViewPos, 1.0);
+    // The position is already projected (from Compute Shader)
+    vec2 depthSize = unpackSpriteDepthSize(aDepthSize);
+    gl_Position = spriteClipPosition(aNdc, depthSize.x);
 
     // Pass data to Fragment Shader
     Color = aColor;
-    // Calculate LinearDepth from View Space Z (Since aViewPos is in View Space)
-    // Positive depth is -z
-    LinearDepth = -aViewPos.z;
+    // Clip w of the perspective projection is the view depth (-z)
+    LinearDepth = depthSize.x;
 
     // Point Size
     // This is the size ready for rasterization.
-    gl_PointSize = aSize * pointMultiplier;
+    gl_PointSize = depthSize.y * pointMultiplier;
 }
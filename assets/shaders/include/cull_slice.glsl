@@ -0,0 +1,40 @@
+// Temporal slicing of the cull passes (CullSlicer.h)
+// One bit per input particle, set while its last evaluation rejected it for a reason that
+// holds for a whole slicing cycle. Such particles are evaluated again only in their slice
+// (one slice per frame); everything else is evaluated every frame. Slices are strided by
+// 32-particle word, not by particle: neighbors in the input are neighbors in space (cloud
+// particles, orbit-ordered stars), so whole SIMD groups skip together instead of idling
+// next to the lanes that still evaluate.
+layout(std430, binding = 3) buffer CullSkipBuffer {
+    uint cullSkip[];
+};
+
+uniform int cullSlices;      // Slices per cycle; 1 disables slicing (no bits read or written)
+uniform int cullSlice;       // Slice evaluated this frame; -1 evaluates every particle
+uniform float cullSliceTime; // Simulation time one cycle spans
+
+// Largest angle (radians) a rejected particle may drift across the view during a cycle and
+// still be skipped: a few pixels, well inside the frustum tests' margin
+const float CULL_SLICE_MAX_DRIFT = 0.01;
+
+// True if the particle's last rejection is reused this frame instead of evaluating it
+bool cullSkipped(uint idx) {
+    if (cullSlices <= 1 || cullSlice < 0 || int((idx >> 5) % uint(cullSlices)) == cullSlice) return false;
+    return (cullSkip[idx >> 5] & (1u << (idx & 31u))) != 0u;
+}
+
+// Whether a rejection holds for a cycle: near and fast-moving particles drift too far
+// (speed: world units per unit of simulation time, dist: distance from the camera)
+bool cullStable(float speed, float dist) {
+    return speed * cullSliceTime < CULL_SLICE_MAX_DRIFT * dist;
+}
+
+// Records the outcome of an evaluation; the word is shared with 31 other particles
+void cullRecord(uint idx, bool skip) {
+    if (cullSlices <= 1) return;
+    uint bit = 1u << (idx & 31u);
+    bool skipped = (cullSkip[idx >> 5] & bit) != 0u;
+    if (skip == skipped) return;
+    if (skip) atomicOr(cullSkip[idx >> 5], bit);
+    else atomicAnd(cullSkip[idx >> 5], ~bit);
+}
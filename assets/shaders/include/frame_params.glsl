@@ -0,0 +1,11 @@
+// Per-frame pass parameters (FrameParamsBuffer, binding point 1)
+layout(std140, binding = 1) uniform FrameParams {
+    vec2 renderSize;          // Active render size in pixels (targets may be larger)
+    float zNear;
+    float zFar;
+    float starBrightnessFade; // RenderZone fade (0 at deep system zoom)
+    float gasPointScale;      // Gas particle size -> pixels
+    float starFluxThreshold;  // Stars dimmer than this (mapped brightness) go to the flux image
+    float gasLodArea;         // Projected area (px^2) below which clouds are thinned stochastically
+    float starLodBrightness;  // Mapped brightness below which stars are thinned stochastically (0 = off)
+};
@@ -0,0 +1,10 @@
+// Per-frame camera data (GlobalUniformBuffer, binding point 0)
+#if __VERSION__ >= 420
+layout(std140, binding = 0) uniform GlobalUniforms {
+#else
+layout(std140) uniform GlobalUniforms {
+#endif
+    mat4 view;
+    mat4 projection;
+    vec4 viewPosTime; // xyz: camera position, w: time
+};
@@ -0,0 +1,82 @@
+// Indirect draw arguments written by the cull shaders (glDrawArraysIndirect layout),
+// one per range of the shared sprite arena (SpriteArena.h)
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint first;         // Offset of the range in the output arena
+    uint baseInstance;
+};
+
+layout(std430, binding = 2) buffer IndirectBuffer {
+    DrawCommand cmds[];
+};
+
+uniform int spriteRange; // Range this dispatch appends to (SpriteRange)
+
+// Reserves a slot for every visible invocation in the range's part of the output arena and
+// counts them in its draw; the return value is only meaningful where visible is true.
+// Every invocation of the workgroup must call it (both variants synchronize on barriers),
+// so cull shaders compute visibility first instead of returning early.
+//
+// Both variants compact hierarchically and issue one global atomic per workgroup (~4k for
+// 1M stars instead of one per subgroup or invocation). Workgroups still land in the arena in
+// whatever order their atomics execute; a globally stable order would need a decoupled
+// look-back scan, which relies on forward progress between workgroups that GL doesn't
+// guarantee (and llvmpipe doesn't provide).
+//
+// APPEND_SUBGROUP (SpriteArena::CullDefines): ballot inside each subgroup, then a scan of the
+// subgroup counts (GL_KHR_shader_subgroup_ballot must be required by the including shader).
+// Otherwise: offsets from a shared-memory counter, unordered inside the workgroup. (A
+// Hillis-Steele prefix sum gives ordered output but its 16 barriers made the cull ~3x
+// slower on llvmpipe, and the atomic paths never kept the input order either.)
+#ifdef APPEND_SUBGROUP
+shared uint appendSubgroupOffset[gl_WorkGroupSize.x]; // Sized for the smallest possible subgroup
+shared uint appendBase;
+
+uint appendVisible(bool visible) {
+    uvec4 ballot = subgroupBallot(visible);
+
+    // 1. Each subgroup publishes its count
+    if (subgroupElect()) {
+        appendSubgroupOffset[gl_SubgroupID] = subgroupBallotBitCount(ballot);
+    }
+    barrier();
+
+    // 2. First invocation turns the counts into offsets (in subgroup order) and reserves
+    //    space for the whole workgroup: one atomic per workgroup instead of per subgroup
+    if (gl_LocalInvocationIndex == 0u) {
+        uint total = 0u;
+        for (uint i = 0u; i < gl_NumSubgroups; i++) {
+            uint count = appendSubgroupOffset[i];
+            appendSubgroupOffset[i] = total;
+            total += count;
+        }
+        appendBase = total > 0u ? atomicAdd(cmds[spriteRange].count, total) : 0u;
+    }
+    barrier();
+
+    // 3. Offset by the subgroups and the visible invocations before this one: inside a
+    //    workgroup the output keeps the input order
+    return cmds[spriteRange].first + appendBase + appendSubgroupOffset[gl_SubgroupID] + subgroupBallotExclusiveBitCount(ballot);
+}
+#else
+shared uint appendCount;
+shared uint appendBase;
+
+uint appendVisible(bool visible) {
+    if (gl_LocalInvocationIndex == 0u) appendCount = 0u;
+    barrier();
+
+    // Offset inside the workgroup's block (shared atomics stay on-chip)
+    uint localIndex = visible ? atomicAdd(appendCount, 1u) : 0u;
+    barrier();
+
+    // First invocation reserves space for the whole workgroup
+    if (gl_LocalInvocationIndex == 0u && appendCount > 0u) {
+        appendBase = atomicAdd(cmds[spriteRange].count, appendCount);
+    }
+    barrier();
+
+    return cmds[spriteRange].first + appendBase + localIndex;
+}
+#endif
@@ -0,0 +1,53 @@
+// Packed output sprite (12 bytes) of the SpriteArena: written by the cull shaders, fetched
+// by star.vert / gas.vert through the arena's VAO (attribute formats in SpriteArena.cpp).
+// The cull already projects every sprite, so it stores the result: the vertex shaders
+// rebuild the clip position with two multiply-adds instead of a matrix multiply.
+// Needs include/global_uniforms.glsl and include/frame_params.glsl.
+struct SpriteRender {
+    uint ndcXY;     // Attribute 0: NDC x, y as unorm16 over [-SPRITE_NDC_RANGE, SPRITE_NDC_RANGE]
+    uint depthSize; // Attribute 2 (integer): view depth (= clip w) and size, see packSpriteDepthSize
+    uint color;     // Attribute 1: rgba8
+};
+
+// Covers the cull frustum margins (1.2 for stars, 1.3 for gas); steps of ~0.09 px at 4K
+const float SPRITE_NDC_RANGE = 1.5;
+
+// View depth: unorm over [0, zFar] in the low bits (steps of ~0.02 units at zFar = 20000,
+// finer than the depth buffer beyond a few hundred units). It feeds the soft-particle fade
+// and the depth test, so it gets most of the word
+const uint SPRITE_DEPTH_BITS = 20u;
+const uint SPRITE_DEPTH_MASK = (1u << SPRITE_DEPTH_BITS) - 1u;
+// Size: log2 in the top 12 bits over [2^-12, 2^12] (steps of 0.4%)
+const float SPRITE_SIZE_LOG2_MIN = -12.0;
+const float SPRITE_SIZE_LOG2_RANGE = 24.0;
+const float SPRITE_SIZE_CODES = 4095.0;
+
+uint packSpriteDepthSize(float viewDepth, float size) {
+    float depth = clamp(viewDepth / zFar, 0.0, 1.0) * float(SPRITE_DEPTH_MASK);
+    float sizeCode = clamp((log2(max(size, 1e-30)) - SPRITE_SIZE_LOG2_MIN) / SPRITE_SIZE_LOG2_RANGE, 0.0, 1.0);
+    return uint(depth + 0.5) | (uint(sizeCode * SPRITE_SIZE_CODES + 0.5) << SPRITE_DEPTH_BITS);
+}
+
+// (view depth, size)
+vec2 unpackSpriteDepthSize(uint depthSize) {
+    float depth = float(depthSize & SPRITE_DEPTH_MASK) * (zFar / float(SPRITE_DEPTH_MASK));
+    float sizeCode = float(depthSize >> SPRITE_DEPTH_BITS) / SPRITE_SIZE_CODES;
+    return vec2(depth, exp2(sizeCode * SPRITE_SIZE_LOG2_RANGE + SPRITE_SIZE_LOG2_MIN));
+}
+
+// size: star mapped brightness or gas point size in pixels
+SpriteRender packSprite(vec4 clipPos, float size, uint color) {
+    vec2 ndc = clipPos.xy / clipPos.w;
+    SpriteRender sprite;
+    sprite.ndcXY = packUnorm2x16(ndc / (2.0 * SPRITE_NDC_RANGE) + 0.5);
+    sprite.depthSize = packSpriteDepthSize(clipPos.w, size);
+    sprite.color = color;
+    return sprite;
+}
+
+// Clip position of a packed sprite (ndc: attribute 0 as fetched, in [0, 1]). Assumes the
+// perspective projection of Camera.cpp: clip w is the view depth, clip z depends on it only
+vec4 spriteClipPosition(vec2 ndc, float viewDepth) {
+    ndc = (ndc * 2.0 - 1.0) * SPRITE_NDC_RANGE;
+    return vec4(ndc * viewDepth, projection[2][2] * -viewDepth + projection[3][2], viewDepth);
+}
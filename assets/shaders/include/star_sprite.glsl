@@ -0,0 +1,21 @@
+// Point sprite size of a star (star.vert), also used by star_cull.comp to weigh the flux of
+// stars it accumulates instead of drawing. Needs include/frame_params.glsl.
+// Brightness is the "mappedBrightness" from the cull shader.
+float starPointSize(float brightness) {
+    float screenScale = renderSize.y / 1080.0;
+    // Base size 2.5 ensures everything is resolvable.
+    float bloomSize = 2.5 + 3.0 * log(1.0 + brightness * 8.0);
+    return clamp(bloomSize * screenScale, 2.0 * screenScale, 12.0 * screenScale);
+}
+
+// Mean alpha of the glow sprite (exp(-4 r^2) over the point quad, TextureGenerator mode 3)
+const float GLOW_SPRITE_COVERAGE = 0.1945;
+
+// Fixed point of the unresolved star flux image (star_cull.comp -> star_flux.frag)
+const float STAR_FLUX_SCALE = 16384.0;
+
+// Texels of the flux image in use: half the active render size, rounded up. The image is
+// allocated for the render target capacity, so it may be larger
+ivec2 starFluxActiveSize() {
+    return ivec2(ceil(renderSize * 0.5));
+}
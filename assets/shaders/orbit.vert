@@ -1,15 +1,16 @@
-#version 330 core
-layout (location = 0) in vec3 aPos;
+#version 430 core
+layout (location = 0) in vec3 aPos; // Unit circle on the XZ plane
 
-uniform mat4 model;
-
-layout (std140) uniform GlobalUniforms {
-    mat4 view;
-    mat4 projection;
-    vec4 viewPosTime;
+// One instance per visible orbit
+layout(std430, binding = 4) readonly buffer OrbitInstances {
+    vec4 orbits[]; // xyz: center (the star), w: orbit radius
 };
 
+#include "include/global_uniforms.glsl"
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec4 orbit = orbits[gl_InstanceID];
+    vec3 worldPos = orbit.xyz + aPos * vec3(orbit.w, 1.0, orbit.w);
+    gl_Position = projection * view * vec4(worldPos, 1.0);
 }
@@ -5,6 +5,7 @@ in vec2 TexCoords;
 
 uniform sampler2D scene;
 uniform sampler2D bloomBlur;
+uniform vec2 bloomMaxUV; // Last texel center of the bloom's active region (see downsample.frag)
 uniform float exposure;
 uniform bool bloom;
 
@@ -12,7 +13,7 @@ void main()
 {
     const float gamma = 2.2;
     vec3 hdrColor = texture(scene, TexCoords).rgb;
-    vec3 bloomColor = texture(bloomBlur, TexCoords).rgb;
+    vec3 bloomColor = texture(bloomBlur, min(TexCoords, bloomMaxUV)).rgb;
 
     if(bloom)
         hdrColor += bloomColor; // additive blending
@@ -4,12 +4,22 @@
 
 out vec2 TexCoords;
 
+// Fraction of the source texture covered by the active render size
+// (render targets are allocated with spare capacity, see PostProcessor::Resize)
+uniform vec2 uvScale;
+
 void main() {
     float x = -1.0 + float((gl_VertexID & 1) << 2);
     float y = -1.0 + float((gl_VertexID & 2) << 1);
 
     TexCoords.x = (x + 1.0) * 0.5;
     TexCoords.y = (y + 1.0) * 0.5;
+    TexCoords *= uvScale;
 
+#ifdef AT_FAR_PLANE
+    // Just in front of the far plane: depth-tested against the scene (star_flux.frag)
+    gl_Position = vec4(x, y, 0.99999, 1.0);
+#else
     gl_Position = vec4(x, y, 0.0, 1.0);
+#endif
 }
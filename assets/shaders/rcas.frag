@@ -0,0 +1,36 @@
+#version 330 core
+// Robust contrast-adaptive sharpening (after AMD FidelityFX FSR1 RCAS)
+// Runs on the output of easu.frag at the output size. The sharpening lobe is limited per
+// pixel so the result never leaves the range of the 4 neighbors (no halos or clipping).
+out vec4 FragColor;
+
+uniform sampler2D source;  // Upscaled image, output size
+uniform float sharpness;   // Lobe scale: 1 = strongest, 0.5 = one stop less, ...
+
+// Largest negative lobe (FSR_RCAS_LIMIT): keeps the filter from going unstable
+const float RCAS_LIMIT = 0.25 - 1.0 / 16.0;
+
+void main() {
+    //   b
+    // d e f
+    //   h
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    ivec2 maxP = textureSize(source, 0) - 1;
+    vec3 b = texelFetch(source, clamp(p + ivec2(0, -1), ivec2(0), maxP), 0).rgb;
+    vec3 d = texelFetch(source, clamp(p + ivec2(-1, 0), ivec2(0), maxP), 0).rgb;
+    vec3 e = texelFetch(source, p, 0).rgb;
+    vec3 f = texelFetch(source, clamp(p + ivec2(1, 0), ivec2(0), maxP), 0).rgb;
+    vec3 h = texelFetch(source, clamp(p + ivec2(0, 1), ivec2(0), maxP), 0).rgb;
+
+    vec3 mn4 = min(min(b, d), min(f, h));
+    vec3 mx4 = max(max(b, d), max(f, h));
+
+    // Largest lobe per channel that keeps the output inside [0, 1] given the neighborhood
+    vec3 hitMin = min(mn4, e) / (4.0 * mx4 + 1e-5);
+    vec3 hitMax = (1.0 - max(mx4, e)) / (4.0 * mn4 - 4.0 - 1e-5);
+    vec3 lobeRGB = max(-hitMin, hitMax);
+    float lobe = max(-RCAS_LIMIT, min(max(lobeRGB.r, max(lobeRGB.g, lobeRGB.b)), 0.0)) * sharpness;
+
+    vec3 color = (lobe * (b + d + f + h) + e) / (4.0 * lobe + 1.0);
+    FragColor = vec4(color, 1.0);
+}
@@ -2,7 +2,8 @@
 in vec4 vColor; // rgb: color, a: brightness
 out vec4 FragColor;
 
-uniform sampler2D spriteTexture;
+layout(binding = 0) uniform sampler2D spriteTexture;
+#include "include/frame_params.glsl"
 
 void main() {
     // Sample pre-computed sprite
@@ -10,5 +11,5 @@ void main() {
     float alpha = texture(spriteTexture, gl_PointCoord).a;
 
     // Apply brightness from vertex shader (vColor.a)
-    FragColor = vec4(vColor.rgb, alpha * vColor.a);
+    FragColor = vec4(vColor.rgb, alpha * vColor.a * starBrightnessFade);
 }
@@ -1,33 +1,28 @@
 #version 430 core
-layout(location = 0) in vec3 aPos;        // px, py, pz
-layout(location = 1) in vec4 aColor;      // Unpacked from uint
-layout(location = 2) in float aSize;      // size/brightness
+layout(location = 0) in vec2 aNdc;       // SpriteRender.ndcXY (unorm16, sprite_output.glsl)
+layout(location = 1) in vec4 aColor;     // Unpacked from uint
+layout(location = 2) in uint aDepthSize; // View depth, brightness (packed)
 
 out vec4 vColor; // rgb: color, a: brightness
 
-layout(std140, binding = 0) uniform GlobalUniforms {
-    mat4 view;
-    mat4 projection;
-    vec4 viewPosTime;
-};
-
-uniform float screenHeight;
+#include "include/global_uniforms.glsl"
+#include "include/frame_params.glsl"
+#include "include/star_sprite.glsl"
+#include "include/sprite_output.glsl"
 
 void main() {
-    vec3 pos = aPos;
     vec3 color = aColor.rgb;
-    float brightness = aSize;
+    vec2 depthSize = unpackSpriteDepthSize(aDepthSize);
+    float brightness = depthSize.y;
 
-    gl_Position = projection * view * vec4(pos, 1.0);
+    // Projected by the cull shader
+    gl_Position = spriteClipPosition(aNdc, depthSize.x);
 
     // Size calculation
-    float screenScale = screenHeight / 1080.0;
-    // Base size 2.5 ensures everything is resolvable.
     // Brightness here is already "mappedBrightness" from compute shader
-    float bloomSize = 2.5 + 3.0 * log(1.0 + brightness * 8.0);
-
-    gl_PointSize = clamp(bloomSize * screenScale, 2.0 * screenScale, 12.0 * screenScale);
+    gl_PointSize = starPointSize(brightness);
 
     // Pass color and brightness (in alpha channel) to fragment shader
-    vColor = vec4(color, brightness);
+    // Survivors of the stochastic LOD (aColor.a < 1) carry the flux of the stars dropped for them
+    vColor = vec4(color, brightness / aColor.a);
 }
@@ -0,0 +1,27 @@
+#version 430 core
+// Adds the unresolved star flux accumulated by star_cull.comp to the scene (additive blend)
+out vec4 FragColor;
+
+layout(binding = 0) uniform usampler2DArray starFlux; // Fixed point, layers r, g, b
+#include "include/frame_params.glsl"
+#include "include/star_sprite.glsl"
+
+vec3 fetchFlux(ivec2 texel) {
+    texel = clamp(texel, ivec2(0), starFluxActiveSize() - 1);
+    return vec3(texelFetch(starFlux, ivec3(texel, 0), 0).r,
+                texelFetch(starFlux, ivec3(texel, 1), 0).r,
+                texelFetch(starFlux, ivec3(texel, 2), 0).r);
+}
+
+void main() {
+    // Bilinear reconstruction (integer textures can't be filtered). Each half-resolution texel
+    // covers 2x2 pixels, so its flux is spread over four.
+    vec2 pos = gl_FragCoord.xy * 0.5 - 0.5;
+    ivec2 base = ivec2(floor(pos));
+    vec2 f = pos - vec2(base);
+
+    vec3 flux = mix(mix(fetchFlux(base), fetchFlux(base + ivec2(1, 0)), f.x),
+                    mix(fetchFlux(base + ivec2(0, 1)), fetchFlux(base + ivec2(1, 1)), f.x), f.y);
+
+    FragColor = vec4(flux * (starBrightnessFade / (4.0 * STAR_FLUX_SCALE)), 1.0);
+}
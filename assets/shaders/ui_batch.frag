@@ -3,13 +3,13 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 in vec4 Color;
-in float Mode;
+flat in uint Mode;
 
 uniform sampler2D textTexture;
 
 void main()
 {
-    if (Mode < 0.5) {
+    if (Mode == 0u) {
         // Text Mode: Sample Red channel as alpha
         float alpha = texture(textTexture, TexCoords).r;
         FragColor = vec4(Color.rgb, Color.a * alpha);
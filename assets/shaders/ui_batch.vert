@@ -1,12 +1,12 @@
 #version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoords;
-layout (location = 2) in vec4 aColor;
-layout (location = 3) in float aMode; // 0.0 for Text, 1.0 for Rect
+layout (location = 0) in vec2 aPos;       // int16 pixels
+layout (location = 1) in vec2 aTexCoords; // unorm16
+layout (location = 2) in vec4 aColor;     // RGBA8
+layout (location = 3) in uint aMode;      // 0 for Text, 1 for Rect
 
 out vec2 TexCoords;
 out vec4 Color;
-out float Mode;
+flat out uint Mode;
 
 uniform mat4 projection;
 
@@ -4,6 +4,12 @@ in vec2 TexCoords;
 
 uniform sampler2D srcTexture;
 uniform float filterRadius;
+// Last texel center of the active region (see downsample.frag)
+uniform vec2 maxUV;
+
+vec3 sampleSource(vec2 uv) {
+    return texture(srcTexture, min(uv, maxUV)).rgb;
+}
 
 void main()
 {
@@ -11,17 +17,17 @@ void main()
     float x = filterRadius;
     float y = filterRadius;
 
-    vec3 a = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y + y)).rgb;
-    vec3 b = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y + y)).rgb;
-    vec3 c = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y + y)).rgb;
+    vec3 a = sampleSource(vec2(TexCoords.x - x, TexCoords.y + y));
+    vec3 b = sampleSource(vec2(TexCoords.x,     TexCoords.y + y));
+    vec3 c = sampleSource(vec2(TexCoords.x + x, TexCoords.y + y));
 
-    vec3 d = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y)).rgb;
-    vec3 e = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y)).rgb;
-    vec3 f = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y)).rgb;
+    vec3 d = sampleSource(vec2(TexCoords.x - x, TexCoords.y));
+    vec3 e = sampleSource(vec2(TexCoords.x,     TexCoords.y));
+    vec3 f = sampleSource(vec2(TexCoords.x + x, TexCoords.y));
 
-    vec3 g = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y - y)).rgb;
-    vec3 h = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y - y)).rgb;
-    vec3 i = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y - y)).rgb;
+    vec3 g = sampleSource(vec2(TexCoords.x - x, TexCoords.y - y));
+    vec3 h = sampleSource(vec2(TexCoords.x,     TexCoords.y - y));
+    vec3 i = sampleSource(vec2(TexCoords.x + x, TexCoords.y - y));
 
     vec3 color = e * 4.0;
     color += (b + d + f + h) * 2.0;
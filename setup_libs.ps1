@@ -139,4 +139,15 @@ if (-not (Test-Path $stbDir)) {
     Write-Host "STB already exists. Skipping."
 }
 
+# stb_image_write (frame capture) is checked on its own so existing libs/ folders pick it up
+$stbImgWrite = Join-Path $stbDir "stb_image_write.h"
+
+if (-not (Test-Path $stbImgWrite)) {
+    Write-Host "Downloading stb_image_write..."
+    Invoke-WebRequest -Uri "https://raw.githubusercontent.com/nothings/stb/master/stb_image_write.h" -OutFile $stbImgWrite
+    Check-File $stbImgWrite
+} else {
+    Write-Host "stb_image_write already exists. Skipping."
+}
+
 Write-Host "Dependencies setup successfully."